@@ -0,0 +1,64 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <streambuf>
+
+// Number of successful operator new calls so far, counted by alloc_counter.cpp
+uint64_t allocationCount();
+
+struct BenchResult {
+    double ns_per_op = 0.0;
+    double allocs_per_op = 0.0;
+};
+
+// Run op once to warm caches and lazily allocated state, then time
+// iterations calls and count the allocations they made
+template <typename Op>
+BenchResult measure(int iterations, Op op) {
+    op();
+    
+    uint64_t allocations = allocationCount();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        op();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    
+    BenchResult result;
+    result.ns_per_op = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    result.allocs_per_op = static_cast<double>(allocationCount() - allocations) / iterations;
+    return result;
+}
+
+inline void printHeader(const char* title) {
+    std::cout << title << std::endl;
+    std::cout << "  " << std::left << std::setw(34) << "case" << std::right
+              << std::setw(12) << "ns/op" << std::setw(14) << "allocs/op" << std::endl;
+}
+
+inline void printResult(const char* name, const BenchResult& result) {
+    std::cout << "  " << std::left << std::setw(34) << name << std::right
+              << std::fixed << std::setprecision(1) << std::setw(12) << result.ns_per_op
+              << std::setprecision(3) << std::setw(14) << result.allocs_per_op
+              << std::defaultfloat << std::endl;
+}
+
+// Discards std::cout while alive. Action handlers log every press; this
+// keeps terminal I/O out of the numbers while still paying for formatting.
+class QuietConsole {
+public:
+    QuietConsole() : saved_(std::cout.rdbuf(&null_buffer_)) {}
+    ~QuietConsole() { std::cout.rdbuf(saved_); }
+    
+private:
+    class NullBuffer : public std::streambuf {
+    protected:
+        int overflow(int c) override { return c; }
+        std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+    };
+    
+    NullBuffer null_buffer_;
+    std::streambuf* saved_;
+};
@@ -0,0 +1,97 @@
+// Per-frame button dispatch cost: the old map<string,string> lookup plus
+// string-compare chain versus the compiled GamepadButton -> ButtonAction table.
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "config_manager.h"
+
+namespace {
+
+constexpr int kFrames = 200000;
+
+std::array<uint64_t, kButtonActionCount> g_hits{};
+
+// Replica of the if/else chain GamepadAPI::handleButtonAction() used to walk
+void legacyDispatch(const std::string& action) {
+    if (action.empty()) return;
+    
+    if (action == "left_click") ++g_hits[1];
+    else if (action == "right_click") ++g_hits[2];
+    else if (action == "middle_click") ++g_hits[3];
+    else if (action == "media_play_pause") ++g_hits[4];
+    else if (action == "media_next") ++g_hits[5];
+    else if (action == "media_previous") ++g_hits[6];
+    else if (action == "voice_input") ++g_hits[7];
+    else if (action == "alt_tab") ++g_hits[8];
+    else if (action == "win_tab") ++g_hits[9];
+    else if (action == "escape") ++g_hits[10];
+    else if (action == "enter") ++g_hits[11];
+    else if (action == "windows_key") ++g_hits[12];
+    else if (action == "screenshot") ++g_hits[13];
+    else if (action == "volume_up") ++g_hits[14];
+    else if (action == "volume_down") ++g_hits[15];
+    else if (action == "volume_mute") ++g_hits[16];
+    else if (action == "browser_back") ++g_hits[17];
+    else if (action == "browser_forward") ++g_hits[18];
+    else if (action == "increase_mouse_sensitivity") ++g_hits[19];
+    else if (action == "decrease_mouse_sensitivity") ++g_hits[20];
+    else if (action == "increase_scroll_sensitivity") ++g_hits[21];
+    else if (action == "decrease_scroll_sensitivity") ++g_hits[22];
+    else if (action == "exit") ++g_hits[23];
+}
+
+void tableDispatch(ButtonAction action) {
+    switch (action) {
+        case ButtonAction::Unmapped:
+        case ButtonAction::Count:
+            break;
+        default:
+            ++g_hits[static_cast<size_t>(action)];
+            break;
+    }
+}
+
+template <typename Frame>
+double nsPerFrame(Frame frame) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kFrames; ++i) {
+        frame();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / kFrames;
+}
+
+} // namespace
+
+int main() {
+    ConfigManager config;
+    
+    // Worst case frame: every bindable button produces an edge
+    std::array<std::string, kGamepadButtonCount> names;
+    for (size_t i = 0; i < kGamepadButtonCount; ++i) {
+        names[i] = buttonName(static_cast<GamepadButton>(i));
+    }
+    
+    double legacy = nsPerFrame([&] {
+        for (const auto& name : names) {
+            legacyDispatch(config.getButtonAction(name));
+        }
+    });
+    
+    double table = nsPerFrame([&] {
+        for (size_t i = 0; i < kGamepadButtonCount; ++i) {
+            tableDispatch(config.getButtonAction(static_cast<GamepadButton>(i)));
+        }
+    });
+    
+    uint64_t checksum = 0;
+    for (auto hits : g_hits) checksum += hits;
+    
+    std::cout << "Dispatch of " << kGamepadButtonCount << " button edges per frame" << std::endl;
+    std::cout << "  string map + compare chain: " << legacy << " ns/frame" << std::endl;
+    std::cout << "  compiled action table:      " << table << " ns/frame" << std::endl;
+    std::cout << "  (checksum " << checksum << ")" << std::endl;
+    return 0;
+}
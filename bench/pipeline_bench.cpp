@@ -0,0 +1,441 @@
+// End-to-end cost of the input pipeline without hardware: a synthetic gamepad
+// drives GamepadAPI::processFrame(), output goes to the Null backend and a
+// recording observer stands in for the OS. Also covers config parse/save and
+// raw output batching.
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "auto_repeat.h"
+#include "bench_util.h"
+#include "config_manager.h"
+#include "gamepad_api.h"
+#include "gesture_recognizer.h"
+#include "gyro_motion.h"
+#include "input_simulator.h"
+#include "latency_histogram.h"
+#include "macro_player.h"
+#include "stick_response.h"
+
+namespace {
+
+constexpr int kFrames = 200000;
+constexpr int kConfigIterations = 2000;
+constexpr int kStartupIterations = 1000;
+constexpr int kProfileCopies = 200;  // ~30k-line profile
+constexpr uint64_t kFrameIntervalNs = 1000000;  // 1 kHz pad
+
+// Mock output backend: keeps the last commands of every batch in a fixed
+// ring so the observer itself never allocates
+class RecordingOutput {
+public:
+    void attach(InputSimulator& input_sim) {
+        input_sim.setOutputObserver([this](const OutputBuffer& batch) { record(batch); });
+    }
+    
+    void record(const OutputBuffer& batch) {
+        for (const auto& command : batch) {
+            commands_[count_ % commands_.size()] = command;
+            ++count_;
+        }
+    }
+    
+private:
+    std::array<OutputCommand, 1024> commands_{};
+    uint64_t count_ = 0;
+};
+
+enum class Pattern {
+    Idle,     // sticks centred, nothing pressed
+    Motion,   // left stick circling, right stick scrolling
+    Buttons   // a different button pressed or released every frame
+};
+
+// Deterministic gamepad source; each call advances one 1 ms frame
+class SyntheticGamepad {
+public:
+    explicit SyntheticGamepad(Pattern pattern) : pattern_(pattern) {}
+    
+    const GamepadState& next() {
+        ++frame_;
+        state_.poll_timestamp_ns = frame_ * kFrameIntervalNs;
+        state_.input_timestamp_ns = 0;
+        
+        if (pattern_ == Pattern::Motion) {
+            double angle = frame_ * 0.01;
+            setAxis(GamepadAxis::LeftX, static_cast<float>(0.8 * std::cos(angle)));
+            setAxis(GamepadAxis::LeftY, static_cast<float>(0.8 * std::sin(angle)));
+            setAxis(GamepadAxis::RightY, frame_ % 64 < 32 ? 0.6f : 0.0f);
+        } else if (pattern_ == Pattern::Buttons) {
+            // Buttons whose actions only queue output (no exit, media or
+            // sensitivity changes that would rewrite the config)
+            static constexpr GamepadButton kButtons[] = {
+                GamepadButton::A, GamepadButton::B, GamepadButton::Back,
+                GamepadButton::LeftShoulder, GamepadButton::RightShoulder, GamepadButton::RightStick
+            };
+            state_.buttons ^= buttonBit(kButtons[frame_ % (sizeof(kButtons) / sizeof(kButtons[0]))]);
+            state_.input_timestamp_ns = state_.poll_timestamp_ns - 200000;
+        }
+        return state_;
+    }
+    
+private:
+    Pattern pattern_;
+    GamepadState state_{};
+    uint64_t frame_ = 0;
+    
+    void setAxis(GamepadAxis axis, float value) {
+        state_.axes[static_cast<size_t>(axis)] = value;
+    }
+};
+
+// config_text, if given, is loaded instead of the built-in defaults
+void benchFrames(const char* name, Pattern pattern, const std::string& config_text = "") {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "pipeline_bench_frames.txt";
+    if (!config_text.empty()) {
+        std::ofstream(path) << config_text;
+    }
+    
+    BenchResult result;
+    {
+        QuietConsole quiet;
+        GamepadAPI api;
+        api.setConfigPath(config_text.empty() ? "" : path.string());
+        api.initializeHeadless();
+        
+        RecordingOutput output;
+        output.attach(api.getInputSimulator());
+        
+        SyntheticGamepad gamepad(pattern);
+        result = measure(kFrames, [&] { api.processFrame(gamepad.next()); });
+    }
+    printResult(name, result);
+    
+    if (!config_text.empty()) {
+        std::filesystem::remove(path);
+    }
+}
+
+// Construction plus everything initialize() does that doesn't need SDL, a
+// display or a media player
+void benchStartup() {
+    BenchResult result;
+    {
+        QuietConsole quiet;
+        result = measure(kStartupIterations, [] {
+            GamepadAPI api;
+            api.setConfigPath("");
+            api.initializeHeadless();
+        });
+    }
+    printResult("startup: headless initialize", result);
+}
+
+void benchOutputBatch() {
+    InputSimulator input_sim;
+    input_sim.setBackend(OutputBackend::Null);
+    input_sim.initialize();
+    
+    RecordingOutput output;
+    output.attach(input_sim);
+    
+    // A busy frame: motion, a click, a key tap and a scroll notch
+    BenchResult result = measure(kFrames, [&] {
+        input_sim.moveMouse(3, -2);
+        input_sim.moveMouse(1, 1);
+        input_sim.leftClick();
+        input_sim.sendShortcut(Shortcut::Escape);
+        input_sim.scroll(1);
+        input_sim.flush();
+    });
+    printResult("output: busy frame batch", result);
+    
+    // Every shortcut in turn, each flushed as its own frame
+    int next = 0;
+    result = measure(kFrames, [&] {
+        input_sim.sendShortcut(static_cast<Shortcut>(1 + next++ % (kShortcutCount - 1)));
+        input_sim.flush();
+    });
+    printResult("output: shortcut chord", result);
+}
+
+// One stick through dead zone and curve, sweeping a circle of deflections
+void benchStickResponse(const char* name, const StickSettings& settings) {
+    StickResponse response;
+    response.configure(settings);
+    
+    int step = 0;
+    float sink = 0.0f;
+    BenchResult result = measure(kFrames, [&] {
+        float angle = (step & 1023) * 0.0061f;
+        float radius = ((step >> 3) & 127) / 127.0f;
+        ++step;
+        float x, y;
+        response.apply(radius * std::cos(angle), radius * std::sin(angle), x, y);
+        sink += x + y;
+    });
+    printResult(name, result);
+    if (sink == 12345.0f) std::cout << sink;
+}
+
+// Chords, long presses and double taps on a scripted 1 kHz button stream:
+// every 64 frames a chord, a tap, a double tap and a long press
+void benchGestures() {
+    using B = GamepadButton;
+    GestureTable table;
+    table.chords[0] = {buttonBit(B::LeftShoulder) | buttonBit(B::A), {ButtonAction::AltTab}};
+    table.chords[1] = {buttonBit(B::LeftShoulder) | buttonBit(B::B), {ButtonAction::Escape}};
+    table.chords[2] = {buttonBit(B::RightShoulder) | buttonBit(B::A), {ButtonAction::Enter}};
+    table.chords[3] = {buttonBit(B::LeftShoulder) | buttonBit(B::RightShoulder) | buttonBit(B::A),
+                       {ButtonAction::Screenshot}};
+    table.chord_count = 4;
+    table.hold[static_cast<size_t>(B::X)] = {ButtonAction::MediaNext};
+    table.double_tap[static_cast<size_t>(B::Y)] = {ButtonAction::MediaPrevious};
+    table.hold_ms = 20;
+    table.double_tap_ms = 10;
+    table.compile();
+    
+    std::array<ButtonBinding, kGamepadButtonCount> bindings{};
+    bindings.fill({ButtonAction::LeftClick});
+    
+    static constexpr struct {
+        int frame;
+        ButtonMask buttons;
+    } kScript[] = {
+        {0, buttonBit(B::LeftShoulder)}, {2, buttonBit(B::LeftShoulder) | buttonBit(B::A)}, {6, 0},
+        {8, buttonBit(B::A)}, {9, 0},
+        {12, buttonBit(B::Y)}, {13, 0}, {15, buttonBit(B::Y)}, {16, 0},
+        {20, buttonBit(B::X)}, {50, 0},
+    };
+    
+    GestureRecognizer recognizer;
+    ButtonMask previous = 0;
+    uint64_t frame = 0;
+    size_t events = 0;
+    BenchResult result = measure(kFrames, [&] {
+        ++frame;
+        ButtonMask buttons = previous;
+        for (const auto& step : kScript) {
+            if (step.frame == static_cast<int>(frame % 64)) buttons = step.buttons;
+        }
+        ButtonMask changed = buttons ^ previous;
+        uint64_t now = frame * kFrameIntervalNs;
+        if ((changed & table.deferred) != 0 || recognizer.tracked() != 0) {
+            recognizer.update(table, bindings, buttons, changed & buttons, changed & previous, now, now);
+            events += recognizer.events().size();
+        }
+        previous = buttons;
+    });
+    printResult("gestures: chord/tap/hold stream", result);
+    if (events == 0) std::cout << "  no gestures recognized" << std::endl;
+}
+
+// Auto-repeat on a 1 kHz clock: every button of every pad held, each with
+// turbo at 30/s, and one button per pad pressed and released every 64 ms
+void benchRepeat() {
+    AutoRepeat repeat;
+    RepeatSettings turbo{0, 30, true};
+    ButtonBinding binding{ButtonAction::LeftClick};
+    for (size_t pad = 0; pad < kMaxGamepads; ++pad) {
+        for (size_t button = 0; button < kGamepadButtonCount; ++button) {
+            repeat.start(pad, static_cast<GamepadButton>(button), binding, turbo, 0);
+        }
+    }
+    
+    uint64_t frame = 0;
+    size_t fired = 0;
+    BenchResult result = measure(kFrames, [&] {
+        ++frame;
+        uint64_t now = frame * kFrameIntervalNs;
+        if (frame % 64 == 0) {
+            auto button = static_cast<GamepadButton>((frame / 64) % kGamepadButtonCount);
+            for (size_t pad = 0; pad < kMaxGamepads; ++pad) {
+                repeat.stop(pad, button);
+                repeat.start(pad, button, binding, turbo, now);
+            }
+        }
+        repeat.advance(now, [&](size_t, const ButtonBinding&) { ++fired; });
+    });
+    printResult("repeat: all buttons turbo", result);
+    if (fired == 0) std::cout << "  no repeats fired" << std::endl;
+}
+
+// A 1 kHz gyro: half a second at rest with a small bias, then a slow and
+// a fast sweep, one reading per call
+void benchGyro() {
+    GyroSettings settings;
+    settings.enabled = true;
+    GyroMotion gyro;
+    gyro.configure(settings);
+    
+    std::array<float, 3> gravity = {0.0f, 9.81f, 0.0f};
+    uint64_t reading = 0;
+    int64_t moved = 0;
+    BenchResult result = measure(kFrames, [&] {
+        double t = (reading++ % 2000) / 1000.0;
+        float yaw = t < 0.5 ? 0.0f : static_cast<float>(std::sin(t * 6.0) * (t < 1.2 ? 0.1 : 2.0));
+        GyroSample sample;
+        sample.rate = {0.002f, yaw + 0.01f, -0.001f};
+        sample.dt_us = 1000;
+        gyro.addSample(sample, gravity);
+        int delta_x = 0;
+        int delta_y = 0;
+        gyro.takeMotion(delta_x, delta_y);
+        moved += delta_x;
+    });
+    printResult("gyro: 1 kHz readings", result);
+    if (!gyro.isCalibrated()) std::cout << "  gyro never calibrated" << std::endl;
+    if (moved == 12345) std::cout << moved;
+}
+
+// 30 key taps 3 ms apart, the kind of sequence a macro button fires
+constexpr const char* kBenchMacro =
+    "a, wait:3, b, wait:3, c, wait:3, d, wait:3, e, wait:3, f, wait:3, g, wait:3, h, wait:3, "
+    "i, wait:3, j, wait:3, k, wait:3, l, wait:3, m, wait:3, n, wait:3, o, wait:3, p, wait:3, "
+    "q, wait:3, r, wait:3, s, wait:3, t, wait:3, u, wait:3, v, wait:3, w, wait:3, x, wait:3, "
+    "y, wait:3, z, wait:3, 0, wait:3, 1, wait:3, 2, wait:3, ctrl+3";
+
+void benchMacro() {
+    ConfigManager config;
+    config.setMacro("bench", kBenchMacro);
+    auto events = config.getMacroEvents(0);
+    
+    InputSimulator input_sim;
+    input_sim.setBackend(OutputBackend::Null);
+    input_sim.initialize();
+    RecordingOutput output;
+    output.attach(input_sim);
+    
+    // Scheduling cost: start a macro and step a synthetic 1 kHz clock
+    // through it, one flush per tick
+    MacroPlayer player;
+    uint64_t now = 0;
+    BenchResult result = measure(kFrames / 100, [&] {
+        player.start(events, input_sim, now);
+        while (player.isPlaying()) {
+            now += kFrameIntervalNs;
+            player.advance(now);
+            input_sim.flush();
+        }
+    });
+    printResult("macro: start + play (30 taps)", result);
+    
+    // Playback accuracy on the real clock: sleep until each step is due,
+    // the way the main loop does, and measure how late it is queued
+    MacroPlayer timed;
+    auto clock_origin = std::chrono::steady_clock::now();
+    auto clock_ns = [&] {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - clock_origin).count());
+    };
+    for (int run = 0; run < 5; ++run) {
+        timed.start(events, input_sim, clock_ns());
+        while (timed.isPlaying()) {
+            std::this_thread::sleep_until(clock_origin + std::chrono::nanoseconds(timed.nextDeadlineNs()));
+            timed.advance(clock_ns());
+            input_sim.flush();
+        }
+    }
+    std::cout << "  lateness (us)     count      p50      p95      p99      max" << std::endl;
+    timed.getLateness().printRow(std::cout, "macro steps");
+}
+
+void benchConfig() {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "pipeline_bench_config.txt";
+    std::string filename = path.string();
+    
+    ConfigManager config;
+    BenchResult load;
+    BenchResult serialize;
+    BenchResult save;
+    {
+        QuietConsole quiet;
+        config.saveConfig(filename);
+        load = measure(kConfigIterations, [&] { config.loadConfig(filename); });
+        serialize = measure(kConfigIterations, [&] { config.serialize(); });
+        // Content matches the file, so this is the compare-and-skip path
+        save = measure(kConfigIterations, [&] { config.saveConfig(filename); });
+    }
+    printResult("config: load", load);
+    printResult("config: serialize", serialize);
+    printResult("config: save (unchanged)", save);
+    
+    std::filesystem::remove(path);
+}
+
+// A large hand-written-looking profile: comments, every button and per-pad
+// overrides for all pads, repeated so the parse cost dominates
+std::string largeProfile() {
+    std::string block = "# gaming layout\n\nmouse_sensitivity = 12.5\nscroll_sensitivity = 3\n";
+    block += "invert_scroll = false\nloop_mode = event\npoll_interval_ms = 8\n";
+    for (size_t pad = 1; pad <= kMaxGamepads; ++pad) {
+        block += "pad" + std::to_string(pad) + ".output = separate\n";
+        for (size_t button = 0; button < kGamepadButtonCount; ++button) {
+            const char* name = buttonName(static_cast<GamepadButton>(button));
+            block += std::string(name) + " = left_click\n";
+            block += "  pad" + std::to_string(pad) + "." + name + " = escape\n";
+        }
+    }
+    
+    std::string text;
+    for (int copy = 0; copy < kProfileCopies; ++copy) {
+        text += block;
+    }
+    return text;
+}
+
+void benchParse() {
+    std::string text = largeProfile();
+    size_t lines = static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+    
+    ConfigManager config;
+    BenchResult parse;
+    {
+        QuietConsole quiet;
+        parse = measure(50, [&] { config.parseConfig(text, "bench"); });
+    }
+    std::string name = "config: parse " + std::to_string(lines) + " lines";
+    printResult(name.c_str(), parse);
+    std::cout << "  " << parse.ns_per_op / lines << " ns/line, "
+              << config.getParseErrorCount() << " diagnostics" << std::endl;
+}
+
+} // namespace
+
+int main() {
+    printHeader("Input pipeline (synthetic 1 kHz gamepad, Null output)");
+    benchFrames("frame: idle", Pattern::Idle);
+    benchFrames("frame: pointer + scroll", Pattern::Motion);
+    benchFrames("frame: button edges + dispatch", Pattern::Buttons);
+    // Back toggles every sixth frame, so the layer switches constantly
+    benchFrames("frame: button edges, back = layer", Pattern::Buttons,
+                "layer.nav = button_back\nlayer.nav.button_a = escape\nlayer.nav.button_b = enter\n"
+                "layer.nav.left_stick = scroll\n");
+    benchOutputBatch();
+    benchGestures();
+    benchRepeat();
+    benchGyro();
+    benchMacro();
+    benchStartup();
+    
+    StickSettings s_curve;
+    s_curve.curve = ResponseCurve::SCurve;
+    benchStickResponse("stick: scaled radial + s-curve", s_curve);
+    StickSettings custom;
+    custom.dead_zone_shape = DeadZoneShape::Axial;
+    custom.curve = ResponseCurve::Custom;
+    custom.curve_points = {{{0.25f, 0.05f}, {0.5f, 0.2f}, {0.75f, 0.5f}}};
+    custom.curve_point_count = 3;
+    benchStickResponse("stick: axial + custom points", custom);
+    
+    std::cout << std::endl;
+    printHeader("Config file");
+    benchConfig();
+    benchParse();
+    return 0;
+}
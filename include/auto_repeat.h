@@ -0,0 +1,62 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "button_actions.h"
+#include "timer_wheel.h"
+
+// Typematic repeat for one button: held past delay_ms, its action fires
+// again rate_hz times a second. Turbo starts repeating one interval after
+// the press instead. rate_hz 0 = off.
+struct RepeatSettings {
+    uint32_t delay_ms = 0;
+    uint32_t rate_hz = 0;
+    bool turbo = false;
+    
+    bool enabled() const { return rate_hz > 0; }
+    bool operator==(const RepeatSettings& other) const = default;
+};
+
+// Repeats of held buttons on every pad, one timer each in a TimerWheel.
+// The k-th repeat is due at a fixed offset from the press timestamp, so the
+// schedule only depends on input timestamps and replays reproduce it; a
+// stall skips the repeats it missed instead of firing them in a burst.
+class AutoRepeat {
+public:
+    static_assert(kMaxGamepads * kGamepadButtonCount <= TimerWheel::kCapacity, "timer wheel too small");
+    
+    AutoRepeat();
+    
+    // Button pressed at pressed_ns with binding; no-op if settings are off
+    void start(size_t pad, GamepadButton button, const ButtonBinding& binding, const RepeatSettings& settings,
+               uint64_t pressed_ns);
+    void stop(size_t pad, GamepadButton button);
+    
+    // Call fire(pad, binding) for every repeat due at or before now_ns
+    template <typename Fn>
+    void advance(uint64_t now_ns, Fn&& fire) {
+        wheel_.advance(now_ns, [&](size_t id) {
+            Repeat& repeat = repeats_[id];
+            fire(id / kGamepadButtonCount, repeat.binding);
+            
+            // Next slot on the press-relative grid that is still ahead
+            uint64_t behind = now_ns - repeat.first_ns;
+            repeat.count = static_cast<uint32_t>(behind / repeat.interval_ns) + 1;
+            wheel_.schedule(id, repeat.first_ns + repeat.count * repeat.interval_ns);
+        });
+    }
+    
+    // When the next repeat is due, TimerWheel::kNoDeadline if none
+    uint64_t nextDeadlineNs() const;
+    
+private:
+    struct Repeat {
+        ButtonBinding binding;
+        uint64_t first_ns = 0;
+        uint64_t interval_ns = 0;
+        uint32_t count = 0;
+    };
+    
+    TimerWheel wheel_;
+    std::array<Repeat, kMaxGamepads * kGamepadButtonCount> repeats_;
+};
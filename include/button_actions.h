@@ -0,0 +1,98 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Every bindable gamepad input. Triggers act as buttons once pressed past half travel.
+enum class GamepadButton : uint8_t {
+    A,
+    B,
+    X,
+    Y,
+    Start,
+    Back,
+    Guide,
+    LeftShoulder,
+    RightShoulder,
+    LeftStick,
+    RightStick,
+    DpadUp,
+    DpadDown,
+    DpadLeft,
+    DpadRight,
+    LeftTrigger,
+    RightTrigger,
+    Count
+};
+
+constexpr size_t kGamepadButtonCount = static_cast<size_t>(GamepadButton::Count);
+
+// One bit per GamepadButton
+using ButtonMask = uint32_t;
+static_assert(kGamepadButtonCount <= 32, "ButtonMask is too narrow");
+
+constexpr ButtonMask buttonBit(GamepadButton button) {
+    return ButtonMask{1} << static_cast<unsigned>(button);
+}
+
+// Call fn(GamepadButton) for each set bit, lowest first
+template <typename Fn>
+void forEachButton(ButtonMask mask, Fn&& fn) {
+    while (mask != 0) {
+        fn(static_cast<GamepadButton>(std::countr_zero(mask)));
+        mask &= mask - 1;
+    }
+}
+
+// Gamepads handled at once; each gets a slot (pad1..pad4) in connection order
+constexpr size_t kMaxGamepads = 4;
+
+// Everything a button can be bound to in controller_config.txt
+enum class ButtonAction : uint8_t {
+    Unmapped,
+    LeftClick,
+    RightClick,
+    MiddleClick,
+    MediaPlayPause,
+    MediaNext,
+    MediaPrevious,
+    VoiceInput,
+    AltTab,
+    WinTab,
+    Escape,
+    Enter,
+    WindowsKey,
+    Screenshot,
+    VolumeUp,
+    VolumeDown,
+    VolumeMute,
+    BrowserBack,
+    BrowserForward,
+    IncreaseMouseSensitivity,
+    DecreaseMouseSensitivity,
+    IncreaseScrollSensitivity,
+    DecreaseScrollSensitivity,
+    Exit,
+    // Plays a macro from the config; the binding carries which one
+    Macro,
+    Count
+};
+
+constexpr size_t kButtonActionCount = static_cast<size_t>(ButtonAction::Count);
+
+// What a button is bound to; macro picks the macro for ButtonAction::Macro
+struct ButtonBinding {
+    ButtonAction action = ButtonAction::Unmapped;
+    uint8_t macro = 0;
+    
+    bool operator==(const ButtonBinding& other) const = default;
+};
+
+// Config file names, e.g. "button_a" / "left_click"
+const char* buttonName(GamepadButton button);
+const char* actionName(ButtonAction action);
+
+// Reverse lookups used when compiling the config; return false for unknown names
+bool buttonFromName(std::string_view name, GamepadButton& button);
+bool actionFromName(std::string_view name, ButtonAction& action);
@@ -1,36 +1,254 @@
 #pragma once
 #include <string>
-#include <map>
+#include <string_view>
+#include <array>
+#include <optional>
+#include <span>
+#include <vector>
+#include "auto_repeat.h"
+#include "button_actions.h"
+#include "gesture_recognizer.h"
+#include "gyro_motion.h"
+#include "macro_player.h"
+#include "output_buffer.h"
+#include "pointer_motion.h"
+#include "stick_response.h"
+
+// How GamepadAPI::run() paces its loop
+enum class LoopMode {
+    Event,  // sleep in SDL until input arrives, tick only while a stick is deflected
+    Fixed   // legacy: poll every poll_interval_ms regardless of input
+};
+
+// Range of mouse_sensitivity and scroll_sensitivity; the sensitivity
+// buttons move them by kSensitivityStep within it
+constexpr float kMinSensitivity = 0.2f;
+constexpr float kMaxSensitivity = 5.0f;
+constexpr float kSensitivityStep = 0.2f;
+
+// A problem found while parsing, with 1-based line and column
+struct ConfigDiagnostic {
+    int line;
+    int column;
+    std::string message;
+    
+    bool operator==(const ConfigDiagnostic& other) const = default;
+};
+
+// Macros a config may define; bindings refer to them by index
+constexpr size_t kMaxMacros = 64;
+
+// macro.<name> = <steps>, compiled into a range of the shared event pool
+struct MacroDefinition {
+    std::string name;
+    std::string steps;
+    uint32_t first_event = 0;
+    uint32_t event_count = 0;
+    bool defined = false;
+    // Where a binding first named it, to report it if never defined
+    int reference_line = 0;
+    int reference_column = 0;
+    
+    bool operator==(const MacroDefinition& other) const {
+        return name == other.name && steps == other.steps && defined == other.defined;
+    }
+};
+
+// Layers a config may define, the base mapping (layer 0) included
+constexpr size_t kMaxLayers = 8;
+
+// What a stick drives on a layer
+enum class StickRole : uint8_t {
+    Pointer,
+    Scroll,
+    Off
+};
+
+// layer.<name> = <button>: while the button is held the pad uses the layer's
+// bindings and stick roles; buttons the layer leaves unset keep their mapping
+struct LayerDefinition {
+    std::string name;
+    // GamepadButton::Count until layer.<name> = <button> is read
+    GamepadButton modifier = GamepadButton::Count;
+    std::array<std::optional<ButtonBinding>, kGamepadButtonCount> buttons{};
+    std::array<StickRole, kGamepadStickCount> sticks{StickRole::Pointer, StickRole::Scroll};
+    // Where a setting first named it, to report it if it never gets a button
+    int reference_line = 0;
+    int reference_column = 0;
+    
+    bool operator==(const LayerDefinition& other) const {
+        return name == other.name && modifier == other.modifier && buttons == other.buttons && sticks == other.sticks;
+    }
+};
 
 class ConfigManager {
 public:
     ConfigManager();
     ~ConfigManager();
     
+    // Applies every valid line; returns false if the file is missing or any
+    // line had a problem (see getDiagnostics())
     bool loadConfig(const std::string& filename);
-    bool saveConfig(const std::string& filename);
+    // Same for text already in memory; source_name only prefixes the
+    // printed diagnostics
+    bool parseConfig(std::string_view text, std::string_view source_name);
+    // Replaces the file through a temporary file, fsync and rename so a crash
+    // never leaves it truncated; skips the write if the content is unchanged
+    bool saveConfig(const std::string& filename) const;
+    // The text saveConfig() writes
+    std::string serialize() const;
     void loadDefaults();
     
+    // Problems found by the last loadConfig()/parseConfig()
+    int getParseErrorCount() const;
+    const std::vector<ConfigDiagnostic>& getDiagnostics() const;
+    
+    // Same settings and mappings, ignoring diagnostics (compared when a
+    // reload finds the file unchanged in substance, e.g. after our own save)
+    bool operator==(const ConfigManager& other) const;
+    
     // Get configuration values
     float getMouseSensitivity() const;
     float getScrollSensitivity() const;
     bool getInvertScroll() const;
+    LoopMode getLoopMode() const;
+    int getPollIntervalMs() const;
+    OutputBackend getOutputBackend() const;
+    
+    // Action name bound to a button by config name, "" if unmapped or unknown
+    const char* getButtonAction(std::string_view button) const;
+    
+    // Hot-path lookup into the tables compiled from the mappings; each pad's
+    // base table is the shared mapping with its padN.* overrides applied,
+    // and every layer's table is that with the layer's bindings on top
+    ButtonAction getButtonAction(GamepadButton button) const {
+        return binding_tables_[0][0][static_cast<size_t>(button)].action;
+    }
+    ButtonAction getButtonAction(size_t pad, GamepadButton button) const {
+        return binding_tables_[pad][0][static_cast<size_t>(button)].action;
+    }
+    const ButtonBinding& getButtonBinding(size_t pad, size_t layer, GamepadButton button) const {
+        return binding_tables_[pad][layer][static_cast<size_t>(button)];
+    }
+    const std::array<ButtonBinding, kGamepadButtonCount>& getButtonBindings(size_t pad, size_t layer) const {
+        return binding_tables_[pad][layer];
+    }
+    
+    // Layer switching: the buttons that select a layer while held, the layer
+    // a modifier selects and the modifier of a layer (0 for the base layer
+    // and for unused indices)
+    ButtonMask getLayerModifiers() const { return layer_modifiers_; }
+    size_t getModifierLayer(GamepadButton button) const {
+        return modifier_layers_[static_cast<size_t>(button)];
+    }
+    ButtonMask getLayerModifier(size_t layer) const { return layer_modifier_bits_[layer]; }
+    StickRole getStickRole(size_t layer, GamepadStick stick) const {
+        return stick_roles_[layer][static_cast<size_t>(stick)];
+    }
+    // "base" for layer 0
+    const char* getLayerName(size_t layer) const;
+    
+    // Chords, long presses and double taps (shared by all pads)
+    const GestureTable& getGestures() const { return gestures_; }
+    
+    // Auto-repeat / turbo of a held button (shared by all pads)
+    const RepeatSettings& getRepeat(GamepadButton button) const {
+        return repeats_[static_cast<size_t>(button)];
+    }
     
-    // Button mapping
-    std::string getButtonAction(const std::string& button) const;
+    // Compiled events of a bound macro in playback order; empty if the
+    // macro is unknown or was never defined
+    std::span<const MacroEvent> getMacroEvents(uint8_t macro) const;
+    const char* getMacroName(uint8_t macro) const;
+    
+    // Left-stick pointer ballistics and precision trigger
+    const PointerAcceleration& getPointerAcceleration() const;
+    
+    // Gyro pointer (every pad with a gyro)
+    const GyroSettings& getGyro() const;
+    
+    // Dead zone and response curve of each stick (shared by all pads)
+    const StickSettings& getStickSettings(GamepadStick stick) const;
+    
+    // padN.output = separate: the pad gets its own output device instead of
+    // sharing pad1's
+    bool getSeparateOutput(size_t pad) const;
     
     // Set configuration values
     void setMouseSensitivity(float value);
     void setScrollSensitivity(float value);
     void setInvertScroll(bool value);
-    void setButtonAction(const std::string& button, const std::string& action);
+    void setLoopMode(LoopMode mode);
+    void setPollIntervalMs(int value);
+    void setOutputBackend(OutputBackend backend);
+    void setButtonAction(GamepadButton button, ButtonAction action);
+    void setPadButtonAction(size_t pad, GamepadButton button, ButtonAction action);
+    void setSeparateOutput(size_t pad, bool separate);
+    void setStickSettings(GamepadStick stick, const StickSettings& settings);
+    void setPointerAcceleration(const PointerAcceleration& acceleration);
+    void setGyro(const GyroSettings& gyro);
+    // Define or replace macro.<name>; false if the steps don't compile
+    bool setMacro(std::string_view name, std::string_view steps);
+    void setButtonMacro(GamepadButton button, std::string_view macro);
+    void setGestures(const GestureTable& gestures);
+    void setRepeat(GamepadButton button, const RepeatSettings& repeat);
+    // Define or replace the layer with the same name; false if the table is
+    // full or another layer already uses its modifier
+    bool setLayer(const LayerDefinition& layer);
     
 private:
     float mouse_sensitivity_;
     float scroll_sensitivity_;
     bool invert_scroll_;
-    std::map<std::string, std::string> button_mappings_;
+    LoopMode loop_mode_;
+    int poll_interval_ms_;
+    OutputBackend output_backend_;
+    std::array<ButtonBinding, kGamepadButtonCount> button_mappings_;
+    std::array<std::array<std::optional<ButtonBinding>, kGamepadButtonCount>, kMaxGamepads> pad_button_mappings_;
+    std::array<bool, kMaxGamepads> separate_output_;
+    // Layers 1.. in definition order; index 0 of the compiled tables is the
+    // base mapping
+    std::vector<LayerDefinition> layers_;
+    std::array<std::array<std::array<ButtonBinding, kGamepadButtonCount>, kMaxLayers>, kMaxGamepads> binding_tables_;
+    std::array<std::array<StickRole, kGamepadStickCount>, kMaxLayers> stick_roles_;
+    std::array<uint8_t, kGamepadButtonCount> modifier_layers_;
+    std::array<ButtonMask, kMaxLayers> layer_modifier_bits_;
+    ButtonMask layer_modifiers_;
+    std::array<StickSettings, kGamepadStickCount> stick_settings_;
+    PointerAcceleration pointer_acceleration_;
+    GyroSettings gyro_;
+    GestureTable gestures_;
+    std::array<RepeatSettings, kGamepadButtonCount> repeats_;
+    // Every macro's events back to back; a replaced macro's old range is
+    // left unused until the next loadDefaults()
+    std::vector<MacroDefinition> macros_;
+    std::vector<MacroEvent> macro_events_;
+    std::vector<ConfigDiagnostic> diagnostics_;
+    
+    void compileButtonMappings();
+    
+    // Index of the named macro, added undefined on first use; kMaxMacros
+    // once the table is full
+    size_t macroIndex(std::string_view name);
+    // Index into layers_ of the named layer, added on first use; kMaxLayers
+    // once the table is full
+    size_t layerIndex(std::string_view name);
+    void defineMacro(size_t index, std::string_view steps, std::span<const MacroEvent> events);
+    bool parseBinding(std::string_view value, int line_number, int value_column, ButtonBinding& binding);
+    // "none", an action name or "macro:<name>", as the parser reads it
+    std::string bindingName(const ButtonBinding& binding) const;
     
-    void parseConfigLine(const std::string& line);
-    std::string trim(const std::string& str);
-};
\ No newline at end of file
+    // One "key = value" line; views point into the caller's text
+    void parseConfigLine(std::string_view line, int line_number);
+    bool parsePadSetting(std::string_view key, std::string_view value, int line_number, int key_column, int value_column);
+    // chord.<button>+<button>..., hold.<button> and double_tap.<button>
+    bool parseGestureSetting(std::string_view key, std::string_view value, int line_number, int key_column,
+                             int value_column);
+    // layer.<name>, layer.<name>.<button> and layer.<name>.<stick>
+    bool parseLayerSetting(std::string_view key, std::string_view value, int line_number, int key_column,
+                           int value_column);
+    // repeat.<button> and turbo.<button>
+    bool parseRepeatSetting(std::string_view key, std::string_view value, int line_number, int key_column,
+                            int value_column);
+    void addDiagnostic(int line_number, int column, std::string message);
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "config_manager.h"
+
+// Publishes immutable ConfigManager snapshots to the input loop.
+//
+// One reader thread (the input loop) calls acquire() once per frame and may
+// use the returned snapshot until its next acquire(); that call is two atomic
+// operations and never blocks. Writers (the file watcher, sensitivity
+// buttons) swap in a new snapshot under a writer-only mutex. A replaced
+// snapshot is freed once the reader has passed a later acquire(), so the
+// loop never sees a half-applied or freed config.
+class ConfigStore {
+public:
+    ConfigStore();
+    ~ConfigStore();
+    
+    ConfigStore(const ConfigStore&) = delete;
+    ConfigStore& operator=(const ConfigStore&) = delete;
+    
+    // Reader side: marks the previous snapshot as no longer in use and
+    // returns the current one (nullptr before the first publish)
+    const ConfigManager* acquire();
+    
+    // Writer side: makes the snapshot current and reclaims retired ones
+    void publish(std::unique_ptr<const ConfigManager> snapshot);
+    
+    // Like publish(), but keeps the current snapshot if it already holds the
+    // same settings; returns whether anything changed
+    bool publishIfChanged(std::unique_ptr<const ConfigManager> snapshot);
+    
+    // Copy of the current snapshot for a writer to edit and publish
+    std::unique_ptr<ConfigManager> copyCurrent() const;
+    
+private:
+    struct Retired {
+        const ConfigManager* snapshot;
+        uint64_t reader_epoch;
+    };
+    
+    std::atomic<const ConfigManager*> current_;
+    std::atomic<uint64_t> reader_epoch_;
+    mutable std::mutex writer_mutex_;
+    std::vector<Retired> retired_;
+    
+    void swapLocked(const ConfigManager* snapshot);
+};
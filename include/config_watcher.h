@@ -0,0 +1,34 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <thread>
+#include "config_store.h"
+
+// Watches the config file and publishes a re-parsed snapshot to a
+// ConfigStore whenever it changes, so edits apply without a restart.
+//
+// Parsing happens on the watcher's own thread. A file with errors is
+// reported and ignored, leaving the previous snapshot active. On Linux the
+// containing directory is watched with inotify, which also catches editors
+// that save by renaming a temporary file over the original; elsewhere the
+// modification time is polled once a second.
+class ConfigWatcher {
+public:
+    ConfigWatcher();
+    ~ConfigWatcher();
+    
+    bool start(const std::string& path, ConfigStore& store);
+    void stop();
+    
+private:
+    std::string path_;
+    ConfigStore* store_;
+    std::atomic<bool> running_;
+    std::thread worker_;
+#ifdef __linux__
+    int inotify_fd_;
+#endif
+
+    void watchLoop();
+    void reload();
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "config_manager.h"
+
+// Saves config snapshots on a background thread so the input loop never
+// touches the disk. A burst of changes (holding a sensitivity button, say)
+// is coalesced: each post() restarts a short quiet period and only the
+// latest snapshot is written when it ends. Writes go through
+// ConfigManager::saveConfig(), which is atomic and skips unchanged content.
+class ConfigWriter {
+public:
+    static constexpr std::chrono::milliseconds kQuietPeriod{500};
+    
+    ConfigWriter();
+    ~ConfigWriter();
+    
+    bool start(const std::string& path);
+    // Writes whatever is still pending before returning
+    void stop();
+    
+    // Never blocks on I/O. Returns false if the writer isn't running.
+    bool post(std::unique_ptr<const ConfigManager> config);
+    
+private:
+    std::string path_;
+    std::unique_ptr<const ConfigManager> pending_;
+    std::chrono::steady_clock::time_point due_;
+    bool running_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread worker_;
+    
+    void workerLoop();
+};
@@ -0,0 +1,211 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include "gamepad_controller.h"
+#include "input_simulator.h"
+#include "media_controller.h"
+#include "auto_repeat.h"
+#include "config_manager.h"
+#include "config_watcher.h"
+#include "config_writer.h"
+#include "pointer_motion.h"
+#include "scroll_motion.h"
+#include "stick_response.h"
+#include "latency_histogram.h"
+#include "gamepad_recording.h"
+#include "gesture_recognizer.h"
+#include "gyro_motion.h"
+#include "macro_player.h"
+
+// Maps gamepad input to desktop actions: owns the controller, the output
+// simulator and the media controller and runs the main loop.
+class GamepadAPI {
+public:
+    GamepadAPI();
+    
+    // Config file loaded by initialize() and rewritten when a sensitivity
+    // changes; an empty path keeps the built-in defaults and never writes
+    void setConfigPath(const std::string& path);
+    
+    // Record the live input stream to a file while running
+    void setRecordPath(const std::string& path);
+    
+    // Feed a recording through the normal input processing instead of a
+    // gamepad; output goes to the Null backend
+    void setReplayPath(const std::string& path);
+    
+    // Replay frames back to back instead of with their recorded spacing
+    void setReplayMaxSpeed(bool max_speed);
+    
+    // Write every submitted output event as text, one per line
+    void setOutputTracePath(const std::string& path);
+    
+    bool initialize();
+    void run();
+    void shutdown();
+    
+    // Config and Null output only, without a gamepad or media player, for
+    // driving the pipeline from another source (replay, benchmarks)
+    bool initializeHeadless();
+    
+    // Process one frame of input from the given gamepad slot, with the gyro
+    // readings that arrived with it, and submit its output
+    void processFrame(const GamepadState& state, size_t pad = 0, const SensorReadings& sensors = {});
+    
+    // The shared output every pad uses unless its profile asks for its own
+    InputSimulator& getInputSimulator();
+    
+private:
+    // Everything tracked per gamepad slot
+    struct PadContext {
+        // Previous frame's buttons for edge detection (triggers included)
+        ButtonMask prev_buttons = 0;
+        
+        // Chords, long presses and double taps in progress
+        GestureRecognizer gestures;
+        
+        // Mapping layer selected by the held modifier buttons (0 = base)
+        size_t layer = 0;
+        // What each button's press fired, so its release goes to the layer
+        // and config that saw the press
+        std::array<ButtonBinding, kGamepadButtonCount> held{};
+        
+        // Button hold states for mouse buttons
+        bool left_mouse_held = false;
+        bool right_mouse_held = false;
+        
+        // Sub-pixel pointer integration over the time between polls
+        PointerMotion pointer_motion;
+        bool pointer_moving = false;
+        uint64_t last_poll_timestamp_ns = 0;
+        
+        // Fractional wheel motion from the right stick, same timing
+        ScrollMotion scroll_motion;
+        bool scrolling = false;
+        
+        // Gyro readings to pointer motion, with the pad's learned bias
+        GyroMotion gyro_motion;
+        
+        // Seen connected last frame; a pad that vanishes gets one final
+        // all-released frame
+        bool connected = false;
+        
+        // outputs_[0] unless the pad's profile sets padN.output = separate
+        InputSimulator* output = nullptr;
+    };
+    
+    GamepadController gamepad_;
+    std::array<PadContext, kMaxGamepads> pads_;
+    std::array<InputSimulator, kMaxGamepads> outputs_;
+    MediaController media_ctrl_;
+    // Config snapshots are published by loadSettings(), the file watcher and
+    // sensitivity buttons; config_ is the one this frame uses, refreshed only
+    // on the loop thread by refreshConfig()
+    ConfigStore config_store_;
+    ConfigWatcher config_watcher_;
+    ConfigWriter config_writer_;
+    const ConfigManager* config_;
+    std::string config_path_;
+    bool running_;
+    
+    // Sensitivity settings
+    float mouse_sensitivity_;
+    float scroll_sensitivity_;
+    bool invert_scroll_y_;
+    
+    // Dead zone and curve per stick, rebuilt when the config changes
+    std::array<StickResponse, kGamepadStickCount> stick_responses_;
+    
+    // Macros started by button presses and repeats of held buttons, shared
+    // by all pads
+    MacroPlayer macro_player_;
+    AutoRepeat auto_repeat_;
+    
+    // Loop pacing
+    LoopMode loop_mode_;
+    int poll_interval_ms_;
+    
+    // Loop statistics, reported on exit
+    uint64_t wakeup_count_;
+    
+    // Per-stage latency of frames that carried a button event, reported on
+    // exit and on SIGUSR1
+    LatencyHistogram event_to_poll_latency_;
+    LatencyHistogram dispatch_latency_;
+    LatencyHistogram injection_latency_;
+    LatencyHistogram end_to_end_latency_;
+    uint32_t report_event_type_;
+    
+    // Input recording, replay and output tracing
+    GamepadRecorder recorder_;
+    GamepadReplay replay_;
+    std::string record_path_;
+    std::string replay_path_;
+    std::string trace_path_;
+    std::ofstream output_trace_;
+    bool replay_max_speed_;
+    
+    void loadSettings();
+    // Apply an edit to a copy of the current config, publish it and hand it
+    // to the background writer (nothing is written in headless mode). Safe
+    // mid-frame: config_ is only replaced at the top of the next frame.
+    void updateSettings(const std::function<void(ConfigManager&)>& edit);
+    // Pick up the latest snapshot and the settings mirrored from it
+    void refreshConfig();
+    // How far the configured precision trigger is pulled, 0 if none
+    float precisionAmount(const GamepadState& state) const;
+    // The precision trigger's button bit, kept out of button dispatch
+    ButtonMask precisionButton() const;
+    const StickResponse& stickResponse(GamepadStick stick) const {
+        return stick_responses_[static_cast<size_t>(stick)];
+    }
+    void setupCallbacks();
+    
+    // Point every pad at its output and bring up the shared output plus any
+    // separate ones the profiles ask for
+    bool initializeOutputs(OutputBackend backend);
+    void applyMotionSpeeds();
+    
+    // SIGUSR1 is blocked process-wide in main(); a dedicated thread waits for
+    // it and wakes the main loop with an SDL event, so the report is printed
+    // from the loop thread without touching the histograms concurrently
+    void startReportSignalThread();
+    
+    void runLive();
+    void processLiveFrame();
+    
+    // Replays frames with their recorded spacing, or back to back at maximum
+    // speed; the recorded poll timestamps drive pointer integration either way
+    void runReplay();
+    
+    bool openOutputTrace();
+    
+    // Submits the frame's output and records how long each stage took for the
+    // button events (if any) that this frame was woken by
+    void flushOutput();
+    
+    bool needsContinuousUpdate() const;
+    // Fire the repeats and macro steps due by now_ns
+    void advanceTimers(uint64_t now_ns);
+    // Nanoseconds until the next repeat, macro step or gesture decision is
+    // due (0 if overdue), -1 if nothing is waiting
+    int64_t nanosecondsUntilNextTimer() const;
+    void printLoopStats(std::chrono::steady_clock::duration elapsed) const;
+    void printLatencyReport() const;
+    
+    void handleButtonAction(PadContext& pad, ButtonAction action);
+    void handleButtonRelease(PadContext& pad, ButtonAction action);
+    void startMacro(PadContext& pad, uint8_t macro, uint64_t now_ns);
+    // A binding's press and release, whichever edge or gesture decided them
+    void pressBinding(PadContext& pad, const ButtonBinding& binding, uint64_t now_ns);
+    void releaseBinding(PadContext& pad, const ButtonBinding& binding);
+    // Pick the pad's layer from the held modifiers: a modifier pressed this
+    // frame wins, releasing it falls back to another one still held
+    void updateLayer(size_t slot, ButtonMask buttons, ButtonMask pressed);
+    void processGamepadInput(size_t slot, const GamepadState& state, const SensorReadings& sensors);
+};
@@ -1,32 +1,51 @@
 #pragma once
 #include <SDL3/SDL.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <span>
+#include "button_actions.h"
+#include "gyro_motion.h"
+
+// Axes in SDL_GamepadAxis order
+enum class GamepadAxis : uint8_t {
+    LeftX,
+    LeftY,
+    RightX,
+    RightY,
+    LeftTrigger,
+    RightTrigger,
+    Count
+};
+
+constexpr size_t kGamepadAxisCount = static_cast<size_t>(GamepadAxis::Count);
+// Digital buttons read from SDL, in GamepadButton order (triggers are axes)
+constexpr size_t kGamepadDigitalButtonCount = 15;
+// Trigger travel at which the LeftTrigger/RightTrigger bits are set
+constexpr float kTriggerPressThreshold = 0.5f;
 
 struct GamepadState {
-    float left_stick_x = 0.0f;
-    float left_stick_y = 0.0f;
-    float right_stick_x = 0.0f;
-    float right_stick_y = 0.0f;
-    float left_trigger = 0.0f;
-    float right_trigger = 0.0f;
-    
-    bool button_a = false;
-    bool button_b = false;
-    bool button_x = false;
-    bool button_y = false;
-    bool button_start = false;
-    bool button_back = false;
-    bool button_guide = false;
-    bool left_shoulder = false;
-    bool right_shoulder = false;
-    bool left_stick_button = false;
-    bool right_stick_button = false;
-    
-    bool dpad_up = false;
-    bool dpad_down = false;
-    bool dpad_left = false;
-    bool dpad_right = false;
+    std::array<float, kGamepadAxisCount> axes{};
+    ButtonMask buttons = 0;
+    
+    // SDL timestamp (ns) of the oldest button event drained by the last
+    // update, 0 if there was none, and the SDL tick when that update finished
+    uint64_t input_timestamp_ns = 0;
+    uint64_t poll_timestamp_ns = 0;
+    
+    float axis(GamepadAxis which) const { return axes[static_cast<size_t>(which)]; }
+    bool pressed(GamepadButton button) const { return (buttons & buttonBit(button)) != 0; }
+};
+
+// Gyro readings drained by the last update, oldest first (none unless
+// sensors are enabled and the pad has a gyro), and the latest accelerometer
+// reading in m/s^2. Kept apart from GamepadState so state copies stay small;
+// gyro views the controller's (or replay's) buffer until its next update.
+struct SensorReadings {
+    std::span<const GyroSample> gyro;
+    std::array<float, 3> accel{};
 };
 
 class GamepadController {
@@ -37,20 +56,71 @@ public:
     bool initialize();
     void shutdown();
     
+    // Any pad / the pad in one slot (0..kMaxGamepads-1)
     bool isConnected() const;
+    bool isConnected(size_t slot) const;
+    size_t getConnectedCount() const;
+    
+    // Snapshot of one slot; without an argument the first connected pad
     GamepadState getState() const;
+    GamepadState getState(size_t slot) const;
+    SensorReadings getSensorReadings(size_t slot) const;
+    // Single fields of a slot, for checks that don't need a whole snapshot
+    float getAxis(size_t slot, GamepadAxis axis) const;
+    uint64_t getInputTimestampNs(size_t slot) const;
+    uint64_t getPollTimestampNs() const;
     void update();
     
+    // Block until an SDL event arrives or timeout_ms elapses (-1 waits forever),
+    // then drain the queue and refresh the state like update()
+    void waitForEvents(int timeout_ms);
+    
+    // Turn gyro and accelerometer reports on or off for every pad that has
+    // them, now and as pads connect; off by default since each reading
+    // wakes the loop
+    void setSensorsEnabled(bool enabled);
+    
     void setButtonCallback(std::function<void(int, bool)> callback);
     void setAxisCallback(std::function<void(int, float)> callback);
     
+    // SDL_EVENT_QUIT (SIGINT/SIGTERM) and application-registered user events
+    void setQuitCallback(std::function<void()> callback);
+    void setUserEventCallback(std::function<void(const SDL_UserEvent&)> callback);
+    
+    // Every SDL gamepad event as delivered, before it is applied (recording)
+    void setEventCallback(std::function<void(const SDL_Event&)> callback);
+    
 private:
-    SDL_Gamepad* gamepad_;
-    GamepadState current_state_;
-    GamepadState previous_state_;
+    // Per-pad state as one contiguous array per axis plus one button mask per
+    // pad, indexed by slot, so a frame's update runs as flat loops over all
+    // pads
+    std::array<SDL_Gamepad*, kMaxGamepads> gamepads_;
+    std::array<SDL_JoystickID, kMaxGamepads> gamepad_ids_;
+    std::array<std::array<float, kMaxGamepads>, kGamepadAxisCount> axes_;
+    std::array<ButtonMask, kMaxGamepads> buttons_;
+    std::array<uint64_t, kMaxGamepads> input_timestamps_ns_;
+    std::array<uint64_t, kMaxGamepads> pending_input_timestamps_ns_;
+    uint64_t poll_timestamp_ns_;
+    // Gyro readings since the current update started, per pad
+    std::array<std::array<GyroSample, kMaxGyroSamples>, kMaxGamepads> gyro_samples_;
+    std::array<uint8_t, kMaxGamepads> gyro_counts_;
+    std::array<uint64_t, kMaxGamepads> gyro_timestamps_ns_;
+    std::array<std::array<float, 3>, kMaxGamepads> accel_;
+    bool sensors_enabled_;
+    
     std::function<void(int, bool)> button_callback_;
     std::function<void(int, float)> axis_callback_;
+    std::function<void()> quit_callback_;
+    std::function<void(const SDL_UserEvent&)> user_event_callback_;
+    std::function<void(const SDL_Event&)> event_callback_;
+    
+    bool openGamepad(SDL_JoystickID id);
+    void closeSlot(size_t slot);
+    void applySensors(size_t slot);
+    void addSensorReading(size_t slot, const SDL_GamepadSensorEvent& event);
+    int findSlot(SDL_JoystickID id) const;
     
     void processEvents();
+    void handleEvent(const SDL_Event& event);
     void updateState();
-};
\ No newline at end of file
+};
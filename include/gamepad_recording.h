@@ -0,0 +1,129 @@
+#pragma once
+#include <SDL3/SDL.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include "gamepad_controller.h"
+
+// Binary recording of the gamepad input stream.
+//
+// File layout: a 16-byte header ("GPRC", version, axis and button counts)
+// followed by tagged records. Every record starts with its tag (RecordKind in
+// the low nibble, gamepad slot in the high nibble) and the time since the
+// previous record as a zigzag varint in nanoseconds.
+//
+//   Frame: mask byte (bit 0 buttons, bits 1-6 axes, bit 7 input timestamp),
+//          then only what changed since the same pad's previous frame: the
+//          ButtonMask as a varint, each changed axis as a raw int16, the age
+//          of the oldest button event as a varint
+//   Event: kind, button/axis index, int16 value, device id as a varint
+//   Sensor: written just before a frame that carried gyro readings: their
+//          count, then per reading its interval in us as a varint and the
+//          three rates as float32, then the accelerometer as three float32
+//
+// Axes are stored as the int16 SDL reported and sensor values as the floats
+// it reported, so replay reproduces exactly what GamepadController computed.
+// Version 3 files (no sensor records) still replay.
+enum class RecordKind : uint8_t {
+    Frame,
+    Event,
+    Sensor
+};
+
+enum class RecordedEventKind : uint8_t {
+    ButtonDown,
+    ButtonUp,
+    AxisMotion,
+    Added,
+    Removed
+};
+
+struct RecordedEvent {
+    RecordedEventKind kind = RecordedEventKind::ButtonDown;
+    uint8_t index = 0;
+    int16_t value = 0;
+    uint32_t device = 0;
+    uint64_t timestamp_ns = 0;
+};
+
+class GamepadRecorder {
+public:
+    GamepadRecorder();
+    ~GamepadRecorder();
+    
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+    
+    // One snapshot per connected pad per loop frame, timestamped with its
+    // poll_timestamp_ns, with the gyro readings that arrived with it
+    void recordFrame(const GamepadState& state, size_t pad = 0, const SensorReadings& sensors = {});
+    // Raw SDL gamepad events; anything else is ignored
+    void recordEvent(const SDL_Event& event);
+    
+    uint64_t frameCount() const;
+    uint64_t bytesWritten() const;
+    
+private:
+    std::ofstream file_;
+    std::array<GamepadState, kMaxGamepads> last_states_;
+    uint64_t last_timestamp_ns_;
+    uint64_t frame_count_;
+    uint64_t bytes_written_;
+    std::array<bool, kMaxGamepads> has_frame_;
+    
+    void writeRecord(const uint8_t* data, size_t size);
+};
+
+// Reads a recording through a read-only memory mapping. Decoding works in
+// place on the mapping and the state held here, so stepping through frames
+// never allocates.
+class GamepadReplay {
+public:
+    GamepadReplay();
+    ~GamepadReplay();
+    
+    bool open(const std::string& path);
+    void close();
+    
+    // Next record; frames update the returned state, sensor records the
+    // readings, events fill event
+    bool next(RecordKind& kind, RecordedEvent& event);
+    // Skip ahead to the next frame, returning its full state and its pad
+    bool nextFrame(GamepadState& state, size_t& pad);
+    
+    // State of the pad the last frame belonged to, and the gyro readings
+    // recorded with that frame (valid until the next call to next())
+    const GamepadState& state() const;
+    SensorReadings sensorReadings() const;
+    size_t pad() const;
+    uint64_t eventCount() const;
+    // The file ended inside a record or had an unknown tag
+    bool isCorrupt() const;
+    
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t offset_;
+    std::array<GamepadState, kMaxGamepads> states_;
+    std::array<std::array<GyroSample, kMaxGyroSamples>, kMaxGamepads> gyro_samples_;
+    std::array<uint8_t, kMaxGamepads> gyro_counts_;
+    std::array<std::array<float, 3>, kMaxGamepads> accel_;
+    // A sensor record arrived for the pad's next frame
+    std::array<bool, kMaxGamepads> has_sensor_;
+    size_t pad_;
+    uint64_t timestamp_ns_;
+    uint64_t event_count_;
+    bool corrupt_;
+#ifdef _WIN32
+    void* file_handle_;
+    void* mapping_handle_;
+#endif
+
+    bool readVarint(uint64_t& value);
+    bool readInt16(int16_t& value);
+    bool readFloat(float& value);
+    bool readSensor(size_t pad);
+};
@@ -0,0 +1,105 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "button_actions.h"
+
+// Chords a config may define
+constexpr size_t kMaxChords = 16;
+
+struct ChordBinding {
+    ButtonMask buttons = 0;
+    ButtonBinding binding;
+    
+    bool operator==(const ChordBinding& other) const = default;
+};
+
+// Chords, long presses and double taps, compiled from the config. Only the
+// buttons in deferred go through GestureRecognizer; every other button still
+// fires on its press edge.
+struct GestureTable {
+    std::array<ChordBinding, kMaxChords> chords{};
+    size_t chord_count = 0;
+    // Unmapped where a button has no long-press / double-tap binding
+    std::array<ButtonBinding, kGamepadButtonCount> hold{};
+    std::array<ButtonBinding, kGamepadButtonCount> double_tap{};
+    uint32_t hold_ms = 400;
+    uint32_t double_tap_ms = 250;
+    // How long a chord member waits for the rest of the chord
+    uint32_t chord_window_ms = 50;
+    
+    // Derived by compile(): bit i of chords_by_button[b] = chord i uses b
+    std::array<uint16_t, kGamepadButtonCount> chords_by_button{};
+    ButtonMask deferred = 0;
+    
+    void compile();
+    
+    bool operator==(const GestureTable& other) const = default;
+};
+
+// A binding to press or release, in the order the recognizer decided them
+struct GestureEvent {
+    ButtonBinding binding;
+    bool down;
+};
+
+// Per-pad state machine for the deferred buttons. Each button is idle,
+// pressed (waiting for a chord, its hold time or release), active (a binding
+// is down until release), in a chord, or released once and waiting for a
+// second tap. update() only visits buttons with an edge or a running timer,
+// and all timing comes from the timestamps passed in, so the result is the
+// same at any poll rate and in replays.
+class GestureRecognizer {
+public:
+    static constexpr uint64_t kNoDeadline = UINT64_MAX;
+    
+    GestureRecognizer();
+    
+    // Apply one frame: timers that expired by edge_ns, then the edges
+    // (timestamped edge_ns), then timers that expired by now_ns. bindings is
+    // the pad's plain button mapping, used for taps and committed presses.
+    void update(const GestureTable& table, const std::array<ButtonBinding, kGamepadButtonCount>& bindings,
+                ButtonMask buttons, ButtonMask pressed, ButtonMask released, uint64_t edge_ns, uint64_t now_ns);
+    
+    // What the last update() decided
+    std::span<const GestureEvent> events() const;
+    
+    // Buttons the recognizer is tracking; their releases must reach update()
+    ButtonMask tracked() const { return tracked_; }
+    // When a pending decision falls due, kNoDeadline if none
+    uint64_t nextDeadlineNs(const GestureTable& table) const;
+    
+private:
+    enum class State : uint8_t {
+        Idle,
+        Pressed,
+        Active,
+        InChord,
+        ChordReleased,
+        WaitingSecondTap
+    };
+    
+    std::array<State, kGamepadButtonCount> states_;
+    std::array<uint64_t, kGamepadButtonCount> since_ns_;
+    // The binding an Active or InChord button releases
+    std::array<ButtonBinding, kGamepadButtonCount> active_;
+    // All buttons of the chord an InChord button belongs to
+    std::array<ButtonMask, kGamepadButtonCount> chord_of_;
+    // Buttons per state; timers run for pressing_ and waiting_
+    ButtonMask pressing_;
+    ButtonMask waiting_;
+    ButtonMask tracked_;
+    // Worst case per button: an expired tap (2) and a new press
+    std::array<GestureEvent, 3 * kGamepadButtonCount + kMaxChords> events_;
+    size_t event_count_;
+    
+    void emit(const ButtonBinding& binding, bool down);
+    void set(size_t button, State state, uint64_t since_ns);
+    uint64_t deadlineFor(const GestureTable& table, size_t button) const;
+    void expire(const GestureTable& table, const std::array<ButtonBinding, kGamepadButtonCount>& bindings,
+                uint64_t now_ns);
+    void press(const GestureTable& table, ButtonMask buttons, size_t button, uint64_t edge_ns);
+    void release(const GestureTable& table, const std::array<ButtonBinding, kGamepadButtonCount>& bindings,
+                 size_t button, uint64_t edge_ns);
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// One gyro reading as SDL delivered it: angular velocity in rad/s about the
+// pad's x (pitch), y (yaw) and z (roll) axes, and the sensor time since the
+// pad's previous reading
+struct GyroSample {
+    std::array<float, 3> rate{};
+    uint32_t dt_us = 0;
+    
+    bool operator==(const GyroSample& other) const = default;
+};
+
+// Readings one frame can carry; past that they are averaged into the last
+constexpr size_t kMaxGyroSamples = 16;
+
+// Gyro pointer settings. sensitivity is pixels per degree the pad turns;
+// rotation slower than smoothing (deg/s) is smoothed, twice that passes
+// straight through, 0 turns smoothing off.
+struct GyroSettings {
+    bool enabled = false;
+    float sensitivity = 12.0f;
+    float smoothing = 4.0f;
+    
+    bool operator==(const GyroSettings& other) const = default;
+};
+
+// Turns gyro readings into pointer motion, one reading at a time at the
+// sensor's own rate. The zero-rate bias is learned whenever the pad rests
+// (rates and gravity steady for half a second) and subtracted from every
+// reading. Slow rotation goes through a short exponential filter that
+// hides hand tremor, fast rotation bypasses it so aiming stays immediate.
+// Like PointerMotion, the fractional pixels carry over and the result only
+// depends on the readings, so recorded sessions replay identically.
+class GyroMotion {
+public:
+    GyroMotion();
+    
+    void configure(const GyroSettings& settings);
+    
+    // One reading, with the latest accelerometer value (m/s^2) for rest
+    // detection
+    void addSample(const GyroSample& sample, const std::array<float, 3>& accel);
+    
+    // Whole pixels gathered since the last call
+    void takeMotion(int& delta_x, int& delta_y);
+    
+    // Forget the motion, the filter and the learned bias (another pad may
+    // take the slot)
+    void reset();
+    
+    bool isCalibrated() const { return calibrated_; }
+    const std::array<float, 3>& getBias() const { return bias_; }
+
+private:
+    GyroSettings settings_;
+    std::array<float, 3> bias_;
+    bool calibrated_;
+    // Running averages used to tell whether the pad is resting, seeded by
+    // the first reading
+    std::array<float, 3> mean_rate_;
+    std::array<float, 3> mean_accel_;
+    bool averaging_;
+    double rest_seconds_;
+    // Low-pass part of the tiered smoothing, deg/s (yaw, pitch)
+    double smoothed_x_;
+    double smoothed_y_;
+    double remainder_x_;
+    double remainder_y_;
+    
+    void calibrate(const GyroSample& sample, const std::array<float, 3>& accel, double dt_seconds);
+};
@@ -11,21 +11,79 @@
 #include <Carbon/Carbon.h>
 #endif
 
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "output_buffer.h"
+#ifdef __linux__
+#include "uinput_device.h"
+#endif
+
+// Desktop shortcuts, each sent as one key chord; the keys per platform are
+// in a table in input_simulator.cpp
+enum class Shortcut : uint8_t {
+    VoiceInput,
+    AltTab,
+    WinTab,
+    Escape,
+    Enter,
+    WinKey,
+    Screenshot,
+    BrowserBack,
+    BrowserForward,
+    Count
+};
+
+constexpr size_t kShortcutCount = static_cast<size_t>(Shortcut::Count);
+
+// Keys pressed in order and released in reverse: modifiers first, then the
+// key. count 0 means the chord has no binding on this platform.
+struct KeyChord {
+    std::array<int, 4> keys;
+    uint8_t count;
+};
+
 class InputSimulator {
 public:
     InputSimulator();
     ~InputSimulator();
     
+    // Pick the output backend; call before initialize()
+    void setBackend(OutputBackend backend);
+    OutputBackend getActiveBackend() const;
+    
+    // Name of the uinput device this simulator creates; separate outputs
+    // need distinct names so they can be told apart
+    void setDeviceName(const std::string& name);
+    
     bool initialize();
     void shutdown();
     
+    // Primitives below only queue events; flush() submits everything queued
+    // this frame in one batch and should be called once at frame end
+    void flush();
+    
+    // Counters for the last flushed frame and since startup
+    OutputStats getFrameStats() const;
+    OutputStats getTotalStats() const;
+    uint64_t getFrameCount() const;
+    
+    // Sees each batch right before it is submitted (output traces, tests)
+    void setOutputObserver(std::function<void(const OutputBuffer&)> observer);
+    
     // Mouse control
     void moveMouse(int delta_x, int delta_y);
     void setMousePosition(int x, int y);
     void leftClick();
     void rightClick();
     void middleClick();
-    void scroll(int delta);
+    // Whole notches, positive scrolls up
+    void scroll(int notches);
+    // Hi-res wheel in 1/kWheelUnitsPerNotch notch units, positive scrolls
+    // right and up; backends without hi-res scrolling emit whole notches and
+    // carry the rest
+    void smoothScroll(int units_x, int units_y);
     
     // Mouse button press/release
     void leftMouseDown();
@@ -33,37 +91,63 @@ public:
     void rightMouseDown();
     void rightMouseUp();
     
-    // Keyboard control
+    // Keyboard control (platform key codes: virtual keys on Windows,
+    // keysyms on Linux, CGKeyCodes on macOS)
     void pressKey(int key_code);
     void releaseKey(int key_code);
     void typeKey(int key_code);
     void typeText(const char* text);
     
-    // System shortcuts
-    void triggerVoiceInput();
-    void altTab();  // Alt+Tab task switcher
-    void winTab();  // Win+Tab task view
-    void escape();  // Escape key
-    void enter();   // Enter key
-    void winKey();  // Windows key
-    void screenshot(); // Win+Shift+S
-    void mediaPlayPause();
-    void mediaNext();
-    void mediaPrevious();
-    void volumeUp();
-    void volumeDown();
-    void volumeMute();
-    void browserBack();    // Alt+Left
-    void browserForward(); // Alt+Right
+    // Chords and the shortcut table built on them
+    void sendChord(const KeyChord& chord);
+    void sendShortcut(Shortcut shortcut);
+    
+    // Queue a prebuilt command as is (macro playback)
+    void sendCommand(const OutputCommand& command);
     
 private:
-#ifdef _WIN32
-    void simulateKeyPress(WORD key, bool key_down);
-    void simulateMouseClick(DWORD button, bool button_down);
-#elif __linux__
+    OutputBuffer pending_;
+    OutputStats frame_stats_;
+    OutputStats last_frame_stats_;
+    OutputStats total_stats_;
+    uint64_t frame_count_;
+    OutputBackend backend_;
+    OutputBackend active_backend_;
+    std::function<void(const OutputBuffer&)> output_observer_;
+    std::string device_name_;
+    // Fractions of a step not yet sent by notch-only backends (X11 buttons,
+    // macOS pixels)
+    WheelAccumulator wheel_steps_x_;
+    WheelAccumulator wheel_steps_y_;
+    
+    void queue(const OutputCommand& command);
+    void queueKey(int key_code, bool key_down);
+    void queueMouseButton(MouseButton button, bool button_down);
+    
+    // Hand the pending commands to the OS in one batch
+    void submitPending();
+    
+#ifdef __linux__
     Display* display_;
+    UinputDevice uinput_;
+    // keysym -> keycode for every key the shortcut table uses, resolved
+    // when the display opens and again after a MappingNotify; other
+    // keysyms are resolved on first use and added while there is room
+    struct KeycodeEntry {
+        KeySym keysym;
+        KeyCode keycode;
+    };
+    std::array<KeycodeEntry, 32> keycode_cache_;
+    size_t keycode_cache_size_;
+    bool openX11();
+    bool openUinput();
+    void rebuildKeycodeCache();
+    KeyCode keycodeFor(KeySym keysym);
+    // Drains pending X events, picking up keyboard mapping changes
+    void processXEvents();
     void simulateKeyPress(KeyCode key, bool key_down);
     void simulateMouseClick(int button, bool button_down);
+    void simulateWheelClicks(int up_button, int down_button, int steps);
 #elif __APPLE__
     void simulateKeyPress(CGKeyCode key, bool key_down);
     void simulateMouseClick(CGMouseButton button, bool button_down);
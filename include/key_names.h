@@ -0,0 +1,7 @@
+#pragma once
+#include <string_view>
+
+// Platform key code for a config key name ("ctrl", "tab", "f5", "a", "7"),
+// the same codes InputSimulator::pressKey() takes. Returns false for names
+// this platform has no key for.
+bool keyCodeFromName(std::string_view name, int& key_code);
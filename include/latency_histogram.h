@@ -0,0 +1,36 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Fixed-bucket latency histogram in microseconds. Values below 8 us get exact
+// buckets; above that every power of two is split into 8 linear sub-buckets
+// (~12% resolution) up to ~35 minutes. Recording never allocates, so it is
+// safe to use on the input thread every frame.
+class LatencyHistogram {
+public:
+    static constexpr size_t kBucketCount = 8 + 29 * 8;
+    
+    LatencyHistogram();
+    
+    void record(uint64_t nanoseconds);
+    void reset();
+    
+    uint64_t count() const;
+    uint64_t maxNs() const;
+    
+    // Upper bound (in ns) of the bucket holding the given quantile, 0..1
+    uint64_t percentileNs(double quantile) const;
+    
+    // "name  count  p50  p95  p99  max" in microseconds
+    void printRow(std::ostream& out, const char* name) const;
+    
+private:
+    std::array<uint64_t, kBucketCount> buckets_;
+    uint64_t count_;
+    uint64_t max_ns_;
+    
+    static size_t bucketFor(uint64_t microseconds);
+    static uint64_t bucketUpperBound(size_t index);
+};
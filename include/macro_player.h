@@ -0,0 +1,62 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "latency_histogram.h"
+#include "output_buffer.h"
+
+class InputSimulator;
+
+// One step of a compiled macro: a command and when it is due, in ms from the
+// moment the macro starts
+struct MacroEvent {
+    uint32_t at_ms;
+    OutputCommand command;
+    
+    bool operator==(const MacroEvent& other) const = default;
+};
+
+// Longest macro the config accepts, in events (a tapped key is two)
+constexpr size_t kMaxMacroEvents = 64;
+// Latest a macro event may be scheduled
+constexpr uint32_t kMaxMacroDurationMs = 60000;
+
+// Plays compiled macros against the loop's clock. start() copies the events
+// into a fixed slot, so playback never allocates and survives config reloads;
+// advance() queues every event that has come due. Nothing here sleeps: the
+// main loop wakes itself at nextDeadlineNs(), and replays drive advance()
+// with recorded timestamps, so playback is deterministic.
+class MacroPlayer {
+public:
+    static constexpr size_t kMaxPlaying = 8;
+    static constexpr uint64_t kNoDeadline = UINT64_MAX;
+    
+    MacroPlayer();
+    
+    // Returns false if the macro is empty or every slot is busy
+    bool start(std::span<const MacroEvent> events, InputSimulator& output, uint64_t now_ns);
+    
+    // Queue the events due at or before now_ns on their outputs
+    void advance(uint64_t now_ns);
+    
+    // When the earliest pending event is due, kNoDeadline if nothing plays
+    uint64_t nextDeadlineNs() const;
+    bool isPlaying() const;
+    
+    // How late each event was queued after it came due
+    const LatencyHistogram& getLateness() const;
+    
+private:
+    struct Playback {
+        std::array<MacroEvent, kMaxMacroEvents> events;
+        size_t count = 0;
+        size_t next = 0;
+        uint64_t start_ns = 0;
+        InputSimulator* output = nullptr;
+    };
+    
+    std::array<Playback, kMaxPlaying> playbacks_;
+    size_t playing_;
+    LatencyHistogram lateness_;
+};
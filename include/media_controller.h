@@ -1,5 +1,12 @@
 #pragma once
 
+#if defined(__linux__) || defined(__APPLE__)
+#include "media_executor.h"
+#endif
+#ifdef HAVE_DBUS
+#include "mpris_client.h"
+#endif
+
 class MediaController {
 public:
     MediaController();
@@ -28,9 +35,13 @@ private:
     
 #ifdef _WIN32
     void sendMediaKey(unsigned long key);
-#elif __linux__
-    void sendMediaCommand(const char* command);
-#elif __APPLE__
-    void sendAppleScriptCommand(const char* script);
+#elif defined(__linux__) || defined(__APPLE__)
+    // Helper programs run on this worker, never on the caller's thread
+    MediaExecutor executor_;
+    void sendMediaCommand(MediaCommand command, int amount = 0);
+#endif
+#ifdef HAVE_DBUS
+    MprisClient mpris_;
+    bool sendMprisCommand(const MediaRequest& request);
 #endif
 };
\ No newline at end of file
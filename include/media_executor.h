@@ -0,0 +1,60 @@
+#pragma once
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+enum class MediaCommand : uint8_t {
+    PlayPause,
+    Stop,
+    Next,
+    Previous,
+    VolumeStep,  // amount = signed percent
+    Mute
+};
+
+struct MediaRequest {
+    MediaCommand command;
+    int amount;
+};
+
+// Runs media/volume helper programs (playerctl, pactl, osascript) on a worker
+// thread so the input loop never waits on a fork. Requests go through a small
+// bounded queue; back-to-back volume steps merge into one command, so five
+// quick +5% presses become a single +25%. Programs are spawned directly with
+// an argv array, no shell involved.
+class MediaExecutor {
+public:
+    static constexpr size_t kQueueCapacity = 16;
+    
+    MediaExecutor();
+    ~MediaExecutor();
+    
+    bool start();
+    void stop();
+    
+    // Optional in-process handler tried on the worker before spawning a
+    // helper program; returns true if it took care of the request. Set it
+    // before start().
+    void setHandler(std::function<bool(const MediaRequest&)> handler);
+    
+    // Never blocks on the command itself. Returns false if the queue is full
+    // or the worker isn't running.
+    bool post(MediaCommand command, int amount = 0);
+    
+private:
+    std::array<MediaRequest, kQueueCapacity> queue_;
+    size_t head_;
+    size_t count_;
+    bool running_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::thread worker_;
+    std::function<bool(const MediaRequest&)> handler_;
+    
+    void workerLoop();
+    void execute(const MediaRequest& request);
+};
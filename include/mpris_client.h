@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dbus/dbus.h>
+
+// Talks MPRIS directly on a persistent session bus connection instead of
+// spawning playerctl for each action. A dispatch thread follows
+// PropertiesChanged and NameOwnerChanged signals and keeps the playback
+// status, active player and player volume cached, so the getters never do
+// IPC and each action is a single method call message.
+class MprisClient {
+public:
+    MprisClient();
+    ~MprisClient();
+    
+    bool connect();
+    void disconnect();
+    bool isConnected() const;
+    
+    // Cached state of the active player
+    bool isPlaying() const;
+    int getVolume() const;  // percent, -1 when no player reports a volume
+    std::string getCurrentPlayer() const;
+    bool hasPlayer() const;
+    
+    // Fire-and-forget org.mpris.MediaPlayer2.Player method call ("PlayPause",
+    // "Next", ...). Returns false when there is no player to send it to.
+    bool sendPlayerCommand(const char* method);
+    
+private:
+    struct Player {
+        std::string bus_name;  // org.mpris.MediaPlayer2.<name>
+        std::string owner;     // unique name signals are sent from
+        bool playing;
+        double volume;         // 0..1, negative if unknown
+        uint64_t last_active;
+    };
+    
+    DBusConnection* connection_;
+    std::thread dispatch_thread_;
+    std::atomic<bool> running_;
+    
+    std::atomic<bool> playing_;
+    std::atomic<int> volume_;
+    std::atomic<bool> has_player_;
+    
+    // Players are only modified on the dispatch thread; the lock covers
+    // readers of current_player_ on other threads
+    mutable std::mutex players_mutex_;
+    std::vector<Player> players_;
+    std::string current_player_;
+    uint64_t activity_counter_;
+    // Names that appeared while a signal was being dispatched (dispatch
+    // thread only); addPlayer() blocks on the bus, which must not happen
+    // inside the message filter, so they are added once it has returned
+    std::vector<Player> pending_players_;
+    
+    void dispatchLoop();
+    void discoverPlayers();
+    void addPendingPlayers();
+    void addPlayer(const std::string& bus_name, const std::string& owner);
+    void removePlayer(const std::string& bus_name);
+    void applyProperties(Player& player, DBusMessageIter* changed);
+    void refreshCurrentPlayer();
+    
+    static DBusHandlerResult handleMessage(DBusConnection* connection, DBusMessage* message, void* user_data);
+};
@@ -0,0 +1,97 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Where InputSimulator sends its events. Only Linux has more than one real
+// backend; Null drops everything and is used for replay.
+enum class OutputBackend : uint8_t {
+    Auto,    // uinput under Wayland, XTest otherwise, falling back to the other
+    X11,     // XTest on the X display
+    Uinput,  // kernel virtual device via /dev/uinput
+    Null     // nothing reaches the OS; the output observer still sees every batch
+};
+
+enum class OutputCommandType : uint8_t {
+    MouseMove,    // relative motion by (x, y)
+    MouseWarp,    // absolute position (x, y)
+    MouseButton,  // button press/release
+    Scroll,       // wheel by x horizontal, y vertical 1/kWheelUnitsPerNotch units
+    Key           // platform key code x press/release (an X11 keysym on Linux)
+};
+
+// Hi-res wheel resolution shared by Windows (WHEEL_DELTA) and Linux
+// (REL_WHEEL_HI_RES)
+constexpr int kWheelUnitsPerNotch = 120;
+
+// Turns hi-res wheel units into whole steps for outputs that can only do
+// coarser ones, carrying the rest to the next batch
+class WheelAccumulator {
+public:
+    int add(int units, int units_per_step) {
+        remainder_ += units;
+        int steps = remainder_ / units_per_step;
+        remainder_ -= steps * units_per_step;
+        return steps;
+    }
+    
+    void reset() { remainder_ = 0; }
+    
+private:
+    int remainder_ = 0;
+};
+
+enum class MouseButton : uint8_t {
+    Left,
+    Right,
+    Middle
+};
+
+struct OutputCommand {
+    OutputCommandType type;
+    MouseButton button;
+    bool down;
+    int32_t x;
+    int32_t y;
+    
+    bool operator==(const OutputCommand& other) const = default;
+};
+
+// Events produced during one frame and the number of batches used to submit them
+struct OutputStats {
+    uint32_t events = 0;
+    uint32_t flushes = 0;
+};
+
+// Fixed-capacity queue of output commands for one frame. Never allocates;
+// push() returns false once full so the owner can submit early.
+class OutputBuffer {
+public:
+    static constexpr size_t kCapacity = 64;
+    
+    bool push(const OutputCommand& command) {
+        if (count_ == kCapacity) return false;
+        
+        // Consecutive relative moves collapse into one event
+        if (command.type == OutputCommandType::MouseMove && count_ > 0 &&
+            commands_[count_ - 1].type == OutputCommandType::MouseMove) {
+            commands_[count_ - 1].x += command.x;
+            commands_[count_ - 1].y += command.y;
+            return true;
+        }
+        
+        commands_[count_++] = command;
+        return true;
+    }
+    
+    void clear() { count_ = 0; }
+    bool empty() const { return count_ == 0; }
+    size_t size() const { return count_; }
+    
+    const OutputCommand* begin() const { return commands_.data(); }
+    const OutputCommand* end() const { return commands_.data() + count_; }
+    
+private:
+    std::array<OutputCommand, kCapacity> commands_{};
+    size_t count_ = 0;
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+
+// Nominal pointer speed at full deflection and sensitivity 1.0. Matches the
+// old 15 px per 60 Hz frame so existing sensitivity values feel the same.
+constexpr float kBasePointerSpeed = 900.0f;
+
+enum class PrecisionTrigger : uint8_t {
+    Off,
+    Left,
+    Right
+};
+
+// Pointer ballistics. Holding the stick past threshold builds up a ramp
+// over ramp_ms (faster the further past it is); the ramp eases the gain
+// from 1 up to max_gain and falls back four times as fast once the stick
+// eases off. The precision trigger scales the gain down towards
+// precision_gain as it is pulled in.
+struct PointerAcceleration {
+    float max_gain = 2.0f;  // 1 disables acceleration
+    int ramp_ms = 500;
+    float threshold = 0.9f;
+    PrecisionTrigger precision_trigger = PrecisionTrigger::Off;
+    float precision_gain = 0.25f;
+    
+    bool operator==(const PointerAcceleration& other) const = default;
+};
+
+// Integrates stick velocity (pixels per second) over real elapsed time and
+// hands out whole-pixel deltas, carrying the fractional remainder between
+// frames so slow deflections still move the cursor and speed does not depend
+// on the loop rate. Output depends only on the inputs and dt, so a replayed
+// recording moves the pointer exactly as the live session did.
+class PointerMotion {
+public:
+    PointerMotion();
+    
+    void setSpeed(float pixels_per_second);
+    float getSpeed() const;
+    void setAcceleration(const PointerAcceleration& acceleration);
+    
+    // Advance by dt_seconds with the stick at (x, y) in [-1, 1] and the
+    // precision trigger at precision in [0, 1], and return the integer
+    // motion to emit
+    void integrate(float x, float y, float precision, double dt_seconds, int& delta_x, int& delta_y);
+    
+    // Drop any carried sub-pixel motion and acceleration (stick returned
+    // to rest)
+    void reset();
+    
+    // Current gain before the precision trigger (1 when not accelerating)
+    float getAccelerationGain() const;
+    
+private:
+    float speed_;
+    PointerAcceleration acceleration_;
+    double ramp_;
+    double remainder_x_;
+    double remainder_y_;
+};
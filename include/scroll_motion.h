@@ -0,0 +1,27 @@
+#pragma once
+#include "output_buffer.h"
+
+// Wheel notches per second at full deflection and sensitivity 1.0
+constexpr float kBaseScrollSpeed = 30.0f;
+
+// Integrates stick deflection into wheel motion in 1/kWheelUnitsPerNotch
+// notch units, carrying the fraction between frames so speed follows the
+// deflection and sensitivity instead of the loop rate.
+class ScrollMotion {
+public:
+    ScrollMotion();
+    
+    void setSpeed(float notches_per_second);
+    
+    // Advance by dt_seconds with (horizontal, vertical) deflection in
+    // [-1, 1], positive meaning right and up, and return the units to emit
+    void integrate(float horizontal, float vertical, double dt_seconds, int& units_x, int& units_y);
+    
+    // Drop the carried fraction (stick returned to rest)
+    void reset();
+    
+private:
+    float speed_;
+    double remainder_x_;
+    double remainder_y_;
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+enum class GamepadStick : uint8_t {
+    Left,   // pointer
+    Right,  // scroll
+    Count
+};
+
+constexpr size_t kGamepadStickCount = static_cast<size_t>(GamepadStick::Count);
+
+enum class DeadZoneShape : uint8_t {
+    Axial,        // each axis cut on its own (diagonals snap to the axes)
+    Radial,       // cut on distance from centre, output jumps to the edge value
+    ScaledRadial  // radial, rescaled so output rises from 0 at the edge
+};
+
+enum class ResponseCurve : uint8_t {
+    Linear,
+    Power,   // t^exponent: fine control near the centre
+    SCurve,  // t^e / (t^e + (1-t)^e): slow at both ends
+    Custom   // piecewise linear through curve_points, from (0,0) to (1,1)
+};
+
+struct CurvePoint {
+    float input;
+    float output;
+    
+    bool operator==(const CurvePoint& other) const = default;
+};
+
+constexpr size_t kMaxCurvePoints = 8;
+
+// How one stick's raw deflection becomes its output. Dead zones are
+// fractions of full deflection.
+struct StickSettings {
+    DeadZoneShape dead_zone_shape = DeadZoneShape::ScaledRadial;
+    float dead_zone = 0.1f;
+    // Band at the rim that already reads as full deflection
+    float outer_dead_zone = 0.0f;
+    ResponseCurve curve = ResponseCurve::Linear;
+    float curve_exponent = 2.0f;
+    // Strictly increasing inputs inside (0, 1)
+    std::array<CurvePoint, kMaxCurvePoints> curve_points{};
+    size_t curve_point_count = 0;
+    
+    bool operator==(const StickSettings& other) const = default;
+};
+
+// Per-stick dead zone and response curve. configure() samples the curve
+// into a lookup table once per config change; apply() is a dead zone
+// compare, one square root and an interpolated table read.
+class StickResponse {
+public:
+    static constexpr size_t kTableSize = 256;
+    
+    StickResponse();
+    
+    void configure(const StickSettings& settings);
+    
+    // Raw axes in [-1, 1] to processed axes; (0, 0) inside the dead zone
+    void apply(float x, float y, float& out_x, float& out_y) const;
+    
+private:
+    std::array<float, kTableSize + 1> table_;
+    DeadZoneShape shape_;
+    float dead_zone_;
+    // Deflection past the dead zone maps to (magnitude - offset_) * scale_
+    // on the curve's [0, 1] input
+    float offset_;
+    float scale_;
+    
+    float lookup(float magnitude) const;
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Hashed timer wheel for a fixed set of timer ids: 1 ms slots, each a
+// linked list of the timers due in it (this lap or a later one). advance()
+// only walks the slots between the last call and now, so a frame with
+// nothing due costs a few slot checks however many timers run; nothing
+// allocates. Times are whatever monotonic ns clock the caller uses.
+class TimerWheel {
+public:
+    static constexpr size_t kSlotCount = 1024;
+    static constexpr uint64_t kSlotNs = 1000000;
+    static constexpr size_t kCapacity = 128;
+    static constexpr uint64_t kNoDeadline = UINT64_MAX;
+    
+    TimerWheel();
+    
+    // Arm (or re-arm) timer id, 0..kCapacity-1; a due time already in the
+    // past fires on the next advance()
+    void schedule(size_t id, uint64_t due_ns);
+    void cancel(size_t id);
+    bool isPending(size_t id) const;
+    
+    // Call fire(id) for every timer due at or before now_ns, in slot order.
+    // fire may re-arm or cancel the timer it is called for, not others; a
+    // re-arm that is already due fires again by the next advance().
+    template <typename Fn>
+    void advance(uint64_t now_ns, Fn&& fire) {
+        uint64_t now_tick = now_ns / kSlotNs;
+        uint64_t first_tick = cursor_tick_;
+        // Move the cursor first so overdue re-arms from fire land in the
+        // slot the next call starts with, not one already walked past
+        cursor_tick_ = now_tick;
+        if (pending_count_ == 0) return;
+        
+        // One lap visits every slot, however long since the last call
+        uint64_t last_tick = now_tick - first_tick < kSlotCount ? now_tick : first_tick + kSlotCount - 1;
+        for (uint64_t tick = first_tick; tick <= last_tick; ++tick) {
+            uint16_t id = heads_[tick % kSlotCount];
+            while (id != kEnd) {
+                uint16_t next = entries_[id].next;
+                if (entries_[id].due_ns <= now_ns) {
+                    unlink(id);
+                    fire(static_cast<size_t>(id));
+                }
+                id = next;
+            }
+        }
+    }
+    
+    // Earliest pending due time, kNoDeadline if none
+    uint64_t nextDeadlineNs() const;
+    
+private:
+    static constexpr uint16_t kEnd = UINT16_MAX;
+    
+    struct Entry {
+        uint64_t due_ns = 0;
+        uint16_t prev = kEnd;
+        uint16_t next = kEnd;
+        uint16_t slot = 0;
+        bool pending = false;
+    };
+    
+    std::array<Entry, kCapacity> entries_;
+    std::array<uint16_t, kSlotCount> heads_;
+    uint64_t cursor_tick_;
+    size_t pending_count_;
+    // Recomputed on demand after the set of pending timers changes
+    mutable uint64_t next_deadline_ns_;
+    mutable bool next_deadline_valid_;
+    
+    void unlink(uint16_t id);
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <bitset>
+#include <cstddef>
+#include <linux/input.h>
+#include "output_buffer.h"
+
+// Kernel virtual input device (/dev/uinput) exposing a relative pointer,
+// wheel (with high-resolution axes when the kernel has them) and keyboard.
+// Works without an X server (Wayland, console) and submits a whole frame of
+// OutputCommands with a single write() terminated by one SYN_REPORT.
+class UinputDevice {
+public:
+    UinputDevice();
+    ~UinputDevice();
+    
+    bool open(const char* name);
+    
+    // Use an already prepared descriptor (pipe, socket, ...) instead of
+    // creating a device, e.g. to read back the event stream in tests
+    void adopt(int fd);
+    
+    void close();
+    bool isOpen() const;
+    
+    // Key commands carry X11 keysyms; they are translated to KEY_* codes
+    bool submit(const OutputBuffer& commands);
+    
+private:
+    // Worst case per command is a press/release split plus two axes
+    static constexpr size_t kMaxEvents = OutputBuffer::kCapacity * 4 + 1;
+    
+    int fd_;
+    bool owns_device_;
+    input_event events_[kMaxEvents];
+    size_t event_count_;
+    std::bitset<KEY_CNT> pressed_this_frame_;
+    // Hi-res units not yet reported as a whole REL_WHEEL/REL_HWHEEL notch
+    WheelAccumulator wheel_notches_x_;
+    WheelAccumulator wheel_notches_y_;
+    
+    void emit(unsigned short type, unsigned short code, int value);
+    void emitKey(unsigned short code, bool down);
+};
+
+// X11 keysym -> Linux KEY_* code for the keys the bridge can send, 0 if unknown
+unsigned short keysymToEvdev(unsigned long keysym);
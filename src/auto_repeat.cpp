@@ -0,0 +1,29 @@
+#include "auto_repeat.h"
+
+AutoRepeat::AutoRepeat()
+    : repeats_{}
+{
+}
+
+void AutoRepeat::start(size_t pad, GamepadButton button, const ButtonBinding& binding,
+                       const RepeatSettings& settings, uint64_t pressed_ns) {
+    if (!settings.enabled() || binding.action == ButtonAction::Unmapped || pad >= kMaxGamepads) return;
+    
+    size_t id = pad * kGamepadButtonCount + static_cast<size_t>(button);
+    Repeat& repeat = repeats_[id];
+    repeat.binding = binding;
+    repeat.interval_ns = 1000000000ull / settings.rate_hz;
+    repeat.first_ns = pressed_ns + (settings.turbo ? repeat.interval_ns : settings.delay_ms * 1000000ull);
+    repeat.count = 0;
+    wheel_.schedule(id, repeat.first_ns);
+}
+
+void AutoRepeat::stop(size_t pad, GamepadButton button) {
+    if (pad < kMaxGamepads) {
+        wheel_.cancel(pad * kGamepadButtonCount + static_cast<size_t>(button));
+    }
+}
+
+uint64_t AutoRepeat::nextDeadlineNs() const {
+    return wheel_.nextDeadlineNs();
+}
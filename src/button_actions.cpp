@@ -0,0 +1,90 @@
+#include "button_actions.h"
+
+namespace {
+
+// string_views so lookups compare lengths before bytes; every entry is a
+// literal, so data() stays null-terminated for the const char* accessors
+constexpr std::string_view kButtonNames[kGamepadButtonCount] = {
+    "button_a",
+    "button_b",
+    "button_x",
+    "button_y",
+    "button_start",
+    "button_back",
+    "button_guide",
+    "left_shoulder",
+    "right_shoulder",
+    "left_stick_button",
+    "right_stick_button",
+    "dpad_up",
+    "dpad_down",
+    "dpad_left",
+    "dpad_right",
+    "left_trigger",
+    "right_trigger",
+};
+
+constexpr std::string_view kActionNames[kButtonActionCount] = {
+    "",
+    "left_click",
+    "right_click",
+    "middle_click",
+    "media_play_pause",
+    "media_next",
+    "media_previous",
+    "voice_input",
+    "alt_tab",
+    "win_tab",
+    "escape",
+    "enter",
+    "windows_key",
+    "screenshot",
+    "volume_up",
+    "volume_down",
+    "volume_mute",
+    "browser_back",
+    "browser_forward",
+    "increase_mouse_sensitivity",
+    "decrease_mouse_sensitivity",
+    "increase_scroll_sensitivity",
+    "decrease_scroll_sensitivity",
+    "exit",
+    "macro",
+};
+
+} // namespace
+
+const char* buttonName(GamepadButton button) {
+    size_t index = static_cast<size_t>(button);
+    return index < kGamepadButtonCount ? kButtonNames[index].data() : "";
+}
+
+const char* actionName(ButtonAction action) {
+    size_t index = static_cast<size_t>(action);
+    return index < kButtonActionCount ? kActionNames[index].data() : "";
+}
+
+bool buttonFromName(std::string_view name, GamepadButton& button) {
+    for (size_t i = 0; i < kGamepadButtonCount; ++i) {
+        if (name == kButtonNames[i]) {
+            button = static_cast<GamepadButton>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool actionFromName(std::string_view name, ButtonAction& action) {
+    // "none" and an empty value both unbind the button
+    if (name.empty() || name == "none") {
+        action = ButtonAction::Unmapped;
+        return true;
+    }
+    for (size_t i = 1; i < kButtonActionCount; ++i) {
+        if (name == kActionNames[i]) {
+            action = static_cast<ButtonAction>(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -1,8 +1,377 @@
 #include "config_manager.h"
+#include "key_names.h"
 #include <fstream>
 #include <sstream>
 #include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+bool fileHasContents(const std::string& filename, const std::string& contents) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) return false;
+    
+    std::string existing((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return existing == contents;
+}
+
+// Write to a temporary file next to the target, flush it to disk and rename
+// it over the target, so readers and crashes only ever see the old or the new
+// file, never a truncated one
+bool writeFileAtomically(const std::string& filename, const std::string& contents) {
+    std::string temp_name = filename + ".tmp";
+#ifdef _WIN32
+    HANDLE file = CreateFileA(temp_name.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    
+    DWORD written = 0;
+    bool ok = WriteFile(file, contents.data(), static_cast<DWORD>(contents.size()), &written, nullptr) &&
+              written == contents.size() && FlushFileBuffers(file);
+    CloseHandle(file);
+    if (!ok || !MoveFileExA(temp_name.c_str(), filename.c_str(),
+                            MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        DeleteFileA(temp_name.c_str());
+        return false;
+    }
+    return true;
+#else
+    int fd = open(temp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    
+    const char* data = contents.data();
+    size_t remaining = contents.size();
+    bool ok = true;
+    while (remaining > 0) {
+        ssize_t written = write(fd, data, remaining);
+        if (written < 0) {
+            ok = false;
+            break;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    ok = ok && fsync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(temp_name.c_str(), filename.c_str()) != 0) {
+        unlink(temp_name.c_str());
+        return false;
+    }
+    return true;
+#endif
+}
+
+// Every key the parser accepts besides button names and padN.* settings
+enum class Setting : uint8_t {
+    MouseSensitivity,
+    ScrollSensitivity,
+    InvertScroll,
+    LoopMode,
+    PollIntervalMs,
+    OutputBackend,
+    StickDeadZoneShape,
+    StickDeadZone,
+    StickOuterDeadZone,
+    StickCurve,
+    StickCurveExponent,
+    StickCurvePoints,
+    PointerAccelMaxGain,
+    PointerAccelRampMs,
+    PointerAccelThreshold,
+    PointerPrecisionTrigger,
+    PointerPrecisionGain,
+    GyroPointer,
+    GyroSensitivity,
+    GyroSmoothing,
+    HoldTimeMs,
+    DoubleTapMs,
+    ChordWindowMs
+};
+
+struct SettingName {
+    std::string_view key;
+    Setting setting;
+    GamepadStick stick = GamepadStick::Left;
+};
+
+constexpr SettingName kSettings[] = {
+    {"mouse_sensitivity", Setting::MouseSensitivity},
+    {"scroll_sensitivity", Setting::ScrollSensitivity},
+    {"invert_scroll", Setting::InvertScroll},
+    {"loop_mode", Setting::LoopMode},
+    {"poll_interval_ms", Setting::PollIntervalMs},
+    {"output_backend", Setting::OutputBackend},
+    {"left_stick_dead_zone_shape", Setting::StickDeadZoneShape, GamepadStick::Left},
+    {"left_stick_dead_zone", Setting::StickDeadZone, GamepadStick::Left},
+    {"left_stick_outer_dead_zone", Setting::StickOuterDeadZone, GamepadStick::Left},
+    {"left_stick_curve", Setting::StickCurve, GamepadStick::Left},
+    {"left_stick_curve_exponent", Setting::StickCurveExponent, GamepadStick::Left},
+    {"left_stick_curve_points", Setting::StickCurvePoints, GamepadStick::Left},
+    {"right_stick_dead_zone_shape", Setting::StickDeadZoneShape, GamepadStick::Right},
+    {"right_stick_dead_zone", Setting::StickDeadZone, GamepadStick::Right},
+    {"right_stick_outer_dead_zone", Setting::StickOuterDeadZone, GamepadStick::Right},
+    {"right_stick_curve", Setting::StickCurve, GamepadStick::Right},
+    {"right_stick_curve_exponent", Setting::StickCurveExponent, GamepadStick::Right},
+    {"right_stick_curve_points", Setting::StickCurvePoints, GamepadStick::Right},
+    {"pointer_accel_max_gain", Setting::PointerAccelMaxGain},
+    {"pointer_accel_ramp_ms", Setting::PointerAccelRampMs},
+    {"pointer_accel_threshold", Setting::PointerAccelThreshold},
+    {"pointer_precision_trigger", Setting::PointerPrecisionTrigger},
+    {"pointer_precision_gain", Setting::PointerPrecisionGain},
+    {"gyro_pointer", Setting::GyroPointer},
+    {"gyro_sensitivity", Setting::GyroSensitivity},
+    {"gyro_smoothing", Setting::GyroSmoothing},
+    {"hold_time_ms", Setting::HoldTimeMs},
+    {"double_tap_ms", Setting::DoubleTapMs},
+    {"chord_window_ms", Setting::ChordWindowMs},
+};
+
+struct NamedValue {
+    std::string_view name;
+    uint8_t value;
+};
+
+constexpr NamedValue kDeadZoneShapes[] = {
+    {"axial", static_cast<uint8_t>(DeadZoneShape::Axial)},
+    {"radial", static_cast<uint8_t>(DeadZoneShape::Radial)},
+    {"scaled_radial", static_cast<uint8_t>(DeadZoneShape::ScaledRadial)},
+};
+
+constexpr NamedValue kResponseCurves[] = {
+    {"linear", static_cast<uint8_t>(ResponseCurve::Linear)},
+    {"power", static_cast<uint8_t>(ResponseCurve::Power)},
+    {"s_curve", static_cast<uint8_t>(ResponseCurve::SCurve)},
+    {"custom", static_cast<uint8_t>(ResponseCurve::Custom)},
+};
+
+constexpr NamedValue kStickRoles[] = {
+    {"pointer", static_cast<uint8_t>(StickRole::Pointer)},
+    {"scroll", static_cast<uint8_t>(StickRole::Scroll)},
+    {"off", static_cast<uint8_t>(StickRole::Off)},
+};
+
+constexpr NamedValue kPrecisionTriggers[] = {
+    {"none", static_cast<uint8_t>(PrecisionTrigger::Off)},
+    {"left_trigger", static_cast<uint8_t>(PrecisionTrigger::Left)},
+    {"right_trigger", static_cast<uint8_t>(PrecisionTrigger::Right)},
+};
+
+template <typename Enum, size_t N>
+bool enumFromName(const NamedValue (&names)[N], std::string_view name, Enum& value) {
+    for (const auto& entry : names) {
+        if (entry.name == name) {
+            value = static_cast<Enum>(entry.value);
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename Enum, size_t N>
+std::string_view enumName(const NamedValue (&names)[N], Enum value) {
+    for (const auto& entry : names) {
+        if (entry.value == static_cast<uint8_t>(value)) return entry.name;
+    }
+    return names[0].name;
+}
+
+constexpr std::string_view kWhitespace = " \t\r";
+
+std::string_view trimView(std::string_view text) {
+    size_t first = text.find_first_not_of(kWhitespace);
+    if (first == std::string_view::npos) return {};
+    size_t last = text.find_last_not_of(kWhitespace);
+    return text.substr(first, last - first + 1);
+}
+
+// 1-based column of a view into line
+int columnOf(std::string_view line, std::string_view part) {
+    return static_cast<int>(part.data() - line.data()) + 1;
+}
+
+bool parseFloat(std::string_view text, float& value) {
+    // strtof needs a terminated string; config numbers are short
+    char buffer[32];
+    if (text.empty() || text.size() >= sizeof(buffer)) return false;
+    std::memcpy(buffer, text.data(), text.size());
+    buffer[text.size()] = '\0';
+    
+    char* end = nullptr;
+    float parsed = std::strtof(buffer, &end);
+    if (end != buffer + text.size() || !std::isfinite(parsed)) return false;
+    value = parsed;
+    return true;
+}
+
+bool parseInt(std::string_view text, int& value) {
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+bool parseMilliseconds(std::string_view text, int max, uint32_t& value) {
+    int parsed = 0;
+    if (!parseInt(text, parsed) || parsed < 1 || parsed > max) return false;
+    value = static_cast<uint32_t>(parsed);
+    return true;
+}
+
+bool parseBool(std::string_view text, bool& value) {
+    if (text == "true" || text == "1") {
+        value = true;
+    } else if (text == "false" || text == "0") {
+        value = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseFraction(std::string_view text, float max, float& value) {
+    float parsed = 0.0f;
+    if (!parseFloat(text, parsed) || parsed < 0.0f || parsed >= max) return false;
+    value = parsed;
+    return true;
+}
+
+// "in:out, in:out, ..." with inputs rising inside (0, 1), outputs in [0, 1]
+bool parseCurvePoints(std::string_view text, StickSettings& stick) {
+    std::array<CurvePoint, kMaxCurvePoints> points{};
+    size_t count = 0;
+    float previous_input = 0.0f;
+    while (!text.empty()) {
+        size_t comma = text.find(',');
+        std::string_view item = trimView(text.substr(0, comma));
+        text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
+        
+        size_t colon = item.find(':');
+        if (colon == std::string_view::npos || count == kMaxCurvePoints) return false;
+        CurvePoint point{};
+        if (!parseFloat(trimView(item.substr(0, colon)), point.input) ||
+            !parseFloat(trimView(item.substr(colon + 1)), point.output)) {
+            return false;
+        }
+        if (point.input <= previous_input || point.input >= 1.0f || point.output < 0.0f || point.output > 1.0f) {
+            return false;
+        }
+        previous_input = point.input;
+        points[count++] = point;
+    }
+    stick.curve_points = points;
+    stick.curve_point_count = count;
+    return true;
+}
+
+// Macro and layer names
+bool validName(std::string_view name) {
+    if (name.empty()) return false;
+    for (char c : name) {
+        bool word = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        if (!word) return false;
+    }
+    return true;
+}
+
+struct CompiledMacro {
+    std::array<MacroEvent, kMaxMacroEvents> events{};
+    size_t count = 0;
+    
+    bool add(uint32_t at_ms, const OutputCommand& command) {
+        if (count == kMaxMacroEvents) return false;
+        events[count++] = {at_ms, command};
+        return true;
+    }
+};
+
+bool compileMacroStep(std::string_view step, uint32_t& at_ms, CompiledMacro& macro) {
+    size_t colon = step.find(':');
+    std::string_view verb = colon == std::string_view::npos ? std::string_view() : step.substr(0, colon);
+    std::string_view argument = colon == std::string_view::npos ? step : step.substr(colon + 1);
+    int key_code = 0;
+    
+    if (verb == "wait") {
+        int delay = 0;
+        if (!parseInt(argument, delay) || delay < 0 || delay > static_cast<int>(kMaxMacroDurationMs - at_ms)) {
+            return false;
+        }
+        at_ms += static_cast<uint32_t>(delay);
+        return true;
+    }
+    if (verb == "click") {
+        MouseButton button;
+        if (argument == "left") {
+            button = MouseButton::Left;
+        } else if (argument == "right") {
+            button = MouseButton::Right;
+        } else if (argument == "middle") {
+            button = MouseButton::Middle;
+        } else {
+            return false;
+        }
+        return macro.add(at_ms, {OutputCommandType::MouseButton, button, true, 0, 0}) &&
+               macro.add(at_ms, {OutputCommandType::MouseButton, button, false, 0, 0});
+    }
+    if (verb == "down" || verb == "up") {
+        return keyCodeFromName(argument, key_code) &&
+               macro.add(at_ms, {OutputCommandType::Key, MouseButton::Left, verb == "down", key_code, 0});
+    }
+    if (!verb.empty()) return false;
+    
+    // A key or chord: keys pressed left to right, released in reverse
+    std::array<int, 4> keys{};
+    size_t count = 0;
+    while (true) {
+        size_t plus = argument.find('+');
+        if (count == keys.size() || !keyCodeFromName(argument.substr(0, plus), keys[count++])) return false;
+        if (plus == std::string_view::npos) break;
+        argument = argument.substr(plus + 1);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!macro.add(at_ms, {OutputCommandType::Key, MouseButton::Left, true, keys[i], 0})) return false;
+    }
+    for (size_t i = count; i > 0; --i) {
+        if (!macro.add(at_ms, {OutputCommandType::Key, MouseButton::Left, false, keys[i - 1], 0})) return false;
+    }
+    return true;
+}
+
+// "step, step, ..." into timed events; on failure bad_step is the step
+// that didn't compile
+bool compileMacro(std::string_view steps, CompiledMacro& macro, std::string_view& bad_step) {
+    uint32_t at_ms = 0;
+    while (true) {
+        size_t comma = steps.find(',');
+        std::string_view step = trimView(steps.substr(0, comma));
+        if (!compileMacroStep(step, at_ms, macro)) {
+            bad_step = step.empty() ? steps : step;
+            return false;
+        }
+        if (comma == std::string_view::npos) return true;
+        steps = steps.substr(comma + 1);
+    }
+}
+
+std::string quoted(std::string_view text) {
+    std::string result = "\"";
+    result += text;
+    result += '"';
+    return result;
+}
+
+} // namespace
 
 ConfigManager::ConfigManager() {
     loadDefaults();
@@ -17,107 +386,791 @@ void ConfigManager::loadDefaults() {
     scroll_sensitivity_ = 1.0f;
     invert_scroll_ = true;  // Default to inverted (natural scrolling)
     
+    // Main loop pacing
+    loop_mode_ = LoopMode::Event;
+    poll_interval_ms_ = 16;
+    
+    // Output
+    output_backend_ = OutputBackend::Auto;
+    
+    pointer_acceleration_ = PointerAcceleration{};
+    gyro_ = GyroSettings{};
+    gestures_ = GestureTable{};
+    repeats_.fill(RepeatSettings{});
+    
+    // Sticks
+    stick_settings_.fill(StickSettings{});
+    
+    macros_.clear();
+    macro_events_.clear();
+    layers_.clear();
+    
+    // Every pad shares the default mapping and output until configured
+    for (auto& mappings : pad_button_mappings_) {
+        mappings.fill(std::nullopt);
+    }
+    separate_output_.fill(false);
+    
     // Default button mappings
-    button_mappings_["button_a"] = "left_click";
-    button_mappings_["button_b"] = "right_click";
-    button_mappings_["button_x"] = "media_play_pause";
-    button_mappings_["button_y"] = "voice_input";
-    button_mappings_["button_start"] = "exit";
-    button_mappings_["button_back"] = "escape";
-    button_mappings_["button_guide"] = "windows_key";
-    button_mappings_["left_shoulder"] = "middle_click";
-    button_mappings_["right_shoulder"] = "enter";
-    button_mappings_["left_stick_button"] = "win_tab";
-    button_mappings_["right_stick_button"] = "screenshot";
-    button_mappings_["dpad_up"] = "increase_mouse_sensitivity";
-    button_mappings_["dpad_down"] = "decrease_mouse_sensitivity";
-    button_mappings_["dpad_left"] = "decrease_scroll_sensitivity";
-    button_mappings_["dpad_right"] = "increase_scroll_sensitivity";
-    button_mappings_["left_trigger"] = "media_previous";
-    button_mappings_["right_trigger"] = "media_next";
+    auto bind = [this](GamepadButton button, ButtonAction action) {
+        button_mappings_[static_cast<size_t>(button)] = ButtonBinding{action};
+    };
+    button_mappings_.fill(ButtonBinding{});
+    bind(GamepadButton::A, ButtonAction::LeftClick);
+    bind(GamepadButton::B, ButtonAction::RightClick);
+    bind(GamepadButton::X, ButtonAction::MediaPlayPause);
+    bind(GamepadButton::Y, ButtonAction::VoiceInput);
+    bind(GamepadButton::Start, ButtonAction::Exit);
+    bind(GamepadButton::Back, ButtonAction::Escape);
+    bind(GamepadButton::Guide, ButtonAction::WindowsKey);
+    bind(GamepadButton::LeftShoulder, ButtonAction::MiddleClick);
+    bind(GamepadButton::RightShoulder, ButtonAction::Enter);
+    bind(GamepadButton::LeftStick, ButtonAction::WinTab);
+    bind(GamepadButton::RightStick, ButtonAction::Screenshot);
+    bind(GamepadButton::DpadUp, ButtonAction::IncreaseMouseSensitivity);
+    bind(GamepadButton::DpadDown, ButtonAction::DecreaseMouseSensitivity);
+    bind(GamepadButton::DpadLeft, ButtonAction::DecreaseScrollSensitivity);
+    bind(GamepadButton::DpadRight, ButtonAction::IncreaseScrollSensitivity);
+    bind(GamepadButton::LeftTrigger, ButtonAction::MediaPrevious);
+    bind(GamepadButton::RightTrigger, ButtonAction::MediaNext);
     
     // 添加前进/后退和音量控制作为可选映射
     // 用户可以在配置文件中手动设置这些映射到任意按键
+    
+    compileButtonMappings();
 }
 
 bool ConfigManager::loadConfig(const std::string& filename) {
-    std::ifstream file(filename);
+    // Read the whole file in one go; the parser works on views into it
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
         std::cout << "Config file not found, using defaults: " << filename << std::endl;
         return false;
     }
+    std::string text(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(text.data(), static_cast<std::streamsize>(text.size()));
+    file.close();
     
-    std::string line;
-    while (std::getline(file, line)) {
-        parseConfigLine(line);
+    if (!parseConfig(text, filename)) {
+        std::cerr << "Config loaded from: " << filename << " with " << diagnostics_.size() << " error(s)" << std::endl;
+        return false;
     }
-    
-    file.close();
     std::cout << "Config loaded from: " << filename << std::endl;
     return true;
 }
 
-bool ConfigManager::saveConfig(const std::string& filename) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
+bool ConfigManager::parseConfig(std::string_view text, std::string_view source_name) {
+    diagnostics_.clear();
+    
+    int line_number = 0;
+    size_t line_start = 0;
+    while (line_start < text.size()) {
+        size_t line_end = text.find('\n', line_start);
+        if (line_end == std::string_view::npos) line_end = text.size();
+        parseConfigLine(text.substr(line_start, line_end - line_start), ++line_number);
+        line_start = line_end + 1;
+    }
+    for (const auto& macro : macros_) {
+        if (!macro.defined) {
+            addDiagnostic(macro.reference_line, macro.reference_column, "undefined macro " + quoted(macro.name));
+        }
+    }
+    for (const auto& layer : layers_) {
+        if (layer.modifier == GamepadButton::Count) {
+            addDiagnostic(layer.reference_line, layer.reference_column,
+                          "layer " + quoted(layer.name) + " has no button (layer." + layer.name + " = <button>)");
+        }
+    }
+    compileButtonMappings();
+    
+    for (const auto& diagnostic : diagnostics_) {
+        std::cerr << source_name << ":" << diagnostic.line << ":" << diagnostic.column << ": "
+                  << diagnostic.message << std::endl;
+    }
+    return diagnostics_.empty();
+}
+
+bool ConfigManager::saveConfig(const std::string& filename) const {
+    std::string contents = serialize();
+    if (fileHasContents(filename, contents)) {
+        return true;
+    }
+    
+    if (!writeFileAtomically(filename, contents)) {
         std::cerr << "Failed to save config: " << filename << std::endl;
         return false;
     }
+    std::cout << "Config saved to: " << filename << std::endl;
+    return true;
+}
+
+std::string ConfigManager::serialize() const {
+    std::ostringstream out;
+    out << "# Xbox Controller API Configuration\n";
+    out << "# Generated config file - feel free to edit\n\n";
     
-    file << "# Xbox Controller API Configuration\n";
-    file << "# Generated config file - feel free to edit\n\n";
+    out << "# Sensitivity Settings\n";
+    out << "mouse_sensitivity = " << mouse_sensitivity_ << "\n";
+    out << "scroll_sensitivity = " << scroll_sensitivity_ << "\n";
+    out << "invert_scroll = " << (invert_scroll_ ? "true" : "false") << "\n\n";
     
-    file << "# Sensitivity Settings\n";
-    file << "mouse_sensitivity = " << mouse_sensitivity_ << "\n";
-    file << "scroll_sensitivity = " << scroll_sensitivity_ << "\n";
-    file << "invert_scroll = " << (invert_scroll_ ? "true" : "false") << "\n\n";
+    out << "# Pointer Acceleration\n";
+    out << "# Holding the left stick past pointer_accel_threshold ramps the speed up to\n";
+    out << "# pointer_accel_max_gain times over pointer_accel_ramp_ms (max_gain 1 = off).\n";
+    out << "# pointer_precision_trigger: none, left_trigger, right_trigger; pulling it\n";
+    out << "# scales the speed down to pointer_precision_gain (its button action is ignored)\n";
+    out << "pointer_accel_max_gain = " << pointer_acceleration_.max_gain << "\n";
+    out << "pointer_accel_ramp_ms = " << pointer_acceleration_.ramp_ms << "\n";
+    out << "pointer_accel_threshold = " << pointer_acceleration_.threshold << "\n";
+    out << "pointer_precision_trigger = " << enumName(kPrecisionTriggers, pointer_acceleration_.precision_trigger) << "\n";
+    out << "pointer_precision_gain = " << pointer_acceleration_.precision_gain << "\n\n";
     
-    file << "# Button Mappings\n";
-    file << "# Available actions:\n";
-    file << "#   left_click, right_click, middle_click\n";
-    file << "#   media_play_pause, media_next, media_previous\n";
-    file << "#   voice_input, alt_tab, win_tab, escape, enter\n";
-    file << "#   windows_key, screenshot, volume_up, volume_down, volume_mute\n";
-    file << "#   browser_back, browser_forward\n";
-    file << "#   increase/decrease_mouse/scroll_sensitivity, exit\n\n";
+    out << "# Gyro Pointer\n";
+    out << "# gyro_pointer = true moves the pointer as pads with a gyro turn and tilt;\n";
+    out << "# gyro_sensitivity is pixels per degree. Turning slower than gyro_smoothing\n";
+    out << "# (deg/s) is smoothed to hide tremor, 0 = off. The gyro calibrates itself\n";
+    out << "# whenever the pad rests for half a second.\n";
+    out << "gyro_pointer = " << (gyro_.enabled ? "true" : "false") << "\n";
+    out << "gyro_sensitivity = " << gyro_.sensitivity << "\n";
+    out << "gyro_smoothing = " << gyro_.smoothing << "\n\n";
     
-    for (const auto& mapping : button_mappings_) {
-        file << mapping.first << " = " << mapping.second << "\n";
+    out << "# Main Loop\n";
+    out << "# loop_mode: event (wake on input, tick only while a stick is deflected)\n";
+    out << "#            fixed (poll every poll_interval_ms)\n";
+    out << "loop_mode = " << (loop_mode_ == LoopMode::Fixed ? "fixed" : "event") << "\n";
+    out << "poll_interval_ms = " << poll_interval_ms_ << "\n\n";
+    
+    out << "# Output Backend (Linux)\n";
+    out << "# output_backend: auto (uinput under Wayland, XTest otherwise), x11, uinput\n";
+    out << "output_backend = "
+         << (output_backend_ == OutputBackend::X11 ? "x11" :
+             output_backend_ == OutputBackend::Uinput ? "uinput" : "auto") << "\n\n";
+    
+    out << "# Analog Sticks (left: pointer, right: scroll)\n";
+    out << "# *_dead_zone_shape: axial, radial, scaled_radial (output rises from 0 at the edge)\n";
+    out << "# *_dead_zone / *_outer_dead_zone: fraction of full deflection, below 0.5\n";
+    out << "# *_curve: linear, power, s_curve (shaped by *_curve_exponent),\n";
+    out << "#          custom (*_curve_points = in:out, ... with inputs rising inside 0..1)\n";
+    for (size_t index = 0; index < kGamepadStickCount; ++index) {
+        const StickSettings& stick = stick_settings_[index];
+        const char* prefix = index == static_cast<size_t>(GamepadStick::Left) ? "left_stick_" : "right_stick_";
+        out << prefix << "dead_zone_shape = " << enumName(kDeadZoneShapes, stick.dead_zone_shape) << "\n";
+        out << prefix << "dead_zone = " << stick.dead_zone << "\n";
+        out << prefix << "outer_dead_zone = " << stick.outer_dead_zone << "\n";
+        out << prefix << "curve = " << enumName(kResponseCurves, stick.curve) << "\n";
+        out << prefix << "curve_exponent = " << stick.curve_exponent << "\n";
+        out << prefix << "curve_points =";
+        for (size_t point = 0; point < stick.curve_point_count; ++point) {
+            out << (point == 0 ? " " : ", ") << stick.curve_points[point].input << ":" << stick.curve_points[point].output;
+        }
+        out << "\n";
     }
+    out << "\n";
     
-    file.close();
-    std::cout << "Config saved to: " << filename << std::endl;
-    return true;
+    out << "# Macros\n";
+    out << "# macro.<name> = <step>, <step>, ... and bind it with <button> = macro:<name>\n";
+    out << "# Steps: a key or chord (ctrl+shift+t) is tapped, down:<key> / up:<key> hold\n";
+    out << "# and release, click:left|right|middle, wait:<ms> delays the steps after it.\n";
+    out << "# Keys: a-z, 0-9, f1-f12, ctrl, alt, shift, super, tab, escape, enter, space,\n";
+    out << "#       backspace, delete, insert, home, end, page_up, page_down, left, right, up, down, print\n";
+    for (const auto& macro : macros_) {
+        if (macro.defined) {
+            out << "macro." << macro.name << " = " << macro.steps << "\n";
+        }
+    }
+    out << "\n";
+    
+    out << "# Button Mappings\n";
+    out << "# Available actions:\n";
+    out << "#   left_click, right_click, middle_click\n";
+    out << "#   media_play_pause, media_next, media_previous\n";
+    out << "#   voice_input, alt_tab, win_tab, escape, enter\n";
+    out << "#   windows_key, screenshot, volume_up, volume_down, volume_mute\n";
+    out << "#   browser_back, browser_forward\n";
+    out << "#   increase/decrease_mouse/scroll_sensitivity, exit\n";
+    out << "#   macro:<name>\n\n";
+    
+    for (size_t button = 0; button < kGamepadButtonCount; ++button) {
+        out << buttonName(static_cast<GamepadButton>(button)) << " = "
+            << bindingName(button_mappings_[button]) << "\n";
+    }
+    
+    out << "\n# Gestures (all pads)\n";
+    out << "# chord.<button>+<button>... = <action> fires when the buttons are pressed together\n";
+    out << "# (within chord_window_ms of each other); hold.<button> = <action> fires after the\n";
+    out << "# button is held for hold_time_ms and double_tap.<button> = <action> on a second\n";
+    out << "# press within double_tap_ms. Those buttons fire their own action on release (a\n";
+    out << "# tap) or once the wait is over, instead of on press.\n";
+    out << "hold_time_ms = " << gestures_.hold_ms << "\n";
+    out << "double_tap_ms = " << gestures_.double_tap_ms << "\n";
+    out << "chord_window_ms = " << gestures_.chord_window_ms << "\n";
+    for (size_t chord = 0; chord < gestures_.chord_count; ++chord) {
+        out << "chord.";
+        const char* separator = "";
+        forEachButton(gestures_.chords[chord].buttons, [&](GamepadButton button) {
+            out << separator << buttonName(button);
+            separator = "+";
+        });
+        out << " = " << bindingName(gestures_.chords[chord].binding) << "\n";
+    }
+    for (size_t button = 0; button < kGamepadButtonCount; ++button) {
+        if (gestures_.hold[button].action != ButtonAction::Unmapped) {
+            out << "hold." << buttonName(static_cast<GamepadButton>(button)) << " = "
+                << bindingName(gestures_.hold[button]) << "\n";
+        }
+        if (gestures_.double_tap[button].action != ButtonAction::Unmapped) {
+            out << "double_tap." << buttonName(static_cast<GamepadButton>(button)) << " = "
+                << bindingName(gestures_.double_tap[button]) << "\n";
+        }
+    }
+    
+    out << "\n# Auto-Repeat (all pads)\n";
+    out << "# repeat.<button> = <delay_ms>, <per_second>: held past delay_ms, the button's\n";
+    out << "# action fires again per_second times a second, like a held key\n";
+    out << "# turbo.<button> = <per_second>: the same without the initial delay\n";
+    out << "# Each repeat releases and presses the action again (a click clicks again, a\n";
+    out << "# macro restarts). Buttons with a chord, hold or double tap don't repeat.\n";
+    for (size_t button = 0; button < kGamepadButtonCount; ++button) {
+        const RepeatSettings& repeat = repeats_[button];
+        if (!repeat.enabled()) continue;
+        const char* name = buttonName(static_cast<GamepadButton>(button));
+        if (repeat.turbo) {
+            out << "turbo." << name << " = " << repeat.rate_hz << "\n";
+        } else {
+            out << "repeat." << name << " = " << repeat.delay_ms << ", " << repeat.rate_hz << "\n";
+        }
+    }
+    
+    out << "\n# Layers\n";
+    out << "# layer.<name> = <button> switches every pad to the layer while the button is\n";
+    out << "# held; the button then only switches layers. layer.<name>.<button> = <action>\n";
+    out << "# rebinds a button on the layer (the rest keep their mapping) and\n";
+    out << "# layer.<name>.left_stick / right_stick = pointer, scroll or off.\n";
+    out << "# A button pressed on one layer is released on that layer.\n";
+    for (const auto& layer : layers_) {
+        if (layer.modifier == GamepadButton::Count) continue;
+        out << "layer." << layer.name << " = " << buttonName(layer.modifier) << "\n";
+        for (size_t button = 0; button < kGamepadButtonCount; ++button) {
+            if (layer.buttons[button]) {
+                out << "layer." << layer.name << "." << buttonName(static_cast<GamepadButton>(button)) << " = "
+                    << bindingName(*layer.buttons[button]) << "\n";
+            }
+        }
+        if (layer.sticks[0] != StickRole::Pointer) {
+            out << "layer." << layer.name << ".left_stick = " << enumName(kStickRoles, layer.sticks[0]) << "\n";
+        }
+        if (layer.sticks[1] != StickRole::Scroll) {
+            out << "layer." << layer.name << ".right_stick = " << enumName(kStickRoles, layer.sticks[1]) << "\n";
+        }
+    }
+    
+    out << "\n# Per-Gamepad Profiles\n";
+    out << "# pad1..pad" << kMaxGamepads << " are assigned in connection order\n";
+    out << "# padN.<button> = <action> overrides the mapping above for that pad\n";
+    out << "# padN.output = shared (default) or separate (own uinput device on Linux)\n";
+    for (size_t pad = 0; pad < kMaxGamepads; ++pad) {
+        if (separate_output_[pad]) {
+            out << "pad" << pad + 1 << ".output = separate\n";
+        }
+        for (size_t button = 0; button < kGamepadButtonCount; ++button) {
+            if (pad_button_mappings_[pad][button]) {
+                out << "pad" << pad + 1 << "." << buttonName(static_cast<GamepadButton>(button)) << " = "
+                    << bindingName(*pad_button_mappings_[pad][button]) << "\n";
+            }
+        }
+    }
+    
+    return out.str();
 }
 
-void ConfigManager::parseConfigLine(const std::string& line) {
+void ConfigManager::compileButtonMappings() {
+    gestures_.compile();
+    
+    // Layer 0 is the base mapping; a layer only becomes reachable once it
+    // has a modifier, but its table is filled either way
+    stick_roles_.fill({StickRole::Pointer, StickRole::Scroll});
+    modifier_layers_.fill(0);
+    layer_modifier_bits_.fill(0);
+    layer_modifiers_ = 0;
+    for (size_t index = 0; index < layers_.size(); ++index) {
+        const LayerDefinition& layer = layers_[index];
+        stick_roles_[index + 1] = layer.sticks;
+        if (layer.modifier == GamepadButton::Count) continue;
+        modifier_layers_[static_cast<size_t>(layer.modifier)] = static_cast<uint8_t>(index + 1);
+        layer_modifier_bits_[index + 1] = buttonBit(layer.modifier);
+        layer_modifiers_ |= buttonBit(layer.modifier);
+    }
+    
+    for (size_t pad = 0; pad < kMaxGamepads; ++pad) {
+        auto& base = binding_tables_[pad][0];
+        base = button_mappings_;
+        for (size_t button = 0; button < kGamepadButtonCount; ++button) {
+            if (pad_button_mappings_[pad][button]) {
+                base[button] = *pad_button_mappings_[pad][button];
+            }
+        }
+        for (size_t layer = 1; layer < kMaxLayers; ++layer) {
+            auto& table = binding_tables_[pad][layer];
+            table = base;
+            if (layer > layers_.size()) continue;
+            for (size_t button = 0; button < kGamepadButtonCount; ++button) {
+                if (layers_[layer - 1].buttons[button]) {
+                    table[button] = *layers_[layer - 1].buttons[button];
+                }
+            }
+        }
+    }
+}
+
+void ConfigManager::parseConfigLine(std::string_view line, int line_number) {
     // Skip empty lines and comments
-    if (line.empty() || line[0] == '#') return;
+    std::string_view content = trimView(line);
+    if (content.empty() || content[0] == '#') return;
+    
+    size_t equals = content.find('=');
+    if (equals == std::string_view::npos) {
+        addDiagnostic(line_number, columnOf(line, content), "expected \"key = value\"");
+        return;
+    }
+    
+    std::string_view key = trimView(content.substr(0, equals));
+    std::string_view value = trimView(content.substr(equals + 1));
+    int key_column = columnOf(line, content);
+    int value_column = value.empty() ? columnOf(line, content) + static_cast<int>(equals) + 1
+                                     : columnOf(line, value);
+    if (key.empty()) {
+        addDiagnostic(line_number, key_column, "missing key before '='");
+        return;
+    }
+    
+    for (const auto& entry : kSettings) {
+        if (entry.key != key) continue;
+        
+        StickSettings& stick = stick_settings_[static_cast<size_t>(entry.stick)];
+        bool valid = true;
+        switch (entry.setting) {
+            case Setting::MouseSensitivity: {
+                float sensitivity = 0.0f;
+                valid = parseFloat(value, sensitivity) && sensitivity >= kMinSensitivity && sensitivity <= kMaxSensitivity;
+                if (valid) mouse_sensitivity_ = sensitivity;
+                break;
+            }
+            case Setting::ScrollSensitivity: {
+                float sensitivity = 0.0f;
+                valid = parseFloat(value, sensitivity) && sensitivity >= kMinSensitivity && sensitivity <= kMaxSensitivity;
+                if (valid) scroll_sensitivity_ = sensitivity;
+                break;
+            }
+            case Setting::InvertScroll:
+                valid = parseBool(value, invert_scroll_);
+                break;
+            case Setting::LoopMode:
+                if (value == "event") {
+                    loop_mode_ = LoopMode::Event;
+                } else if (value == "fixed") {
+                    loop_mode_ = LoopMode::Fixed;
+                } else {
+                    valid = false;
+                }
+                break;
+            case Setting::PollIntervalMs: {
+                int interval = 0;
+                valid = parseInt(value, interval);
+                if (valid) setPollIntervalMs(interval);
+                break;
+            }
+            case Setting::OutputBackend:
+                if (value == "auto") {
+                    output_backend_ = OutputBackend::Auto;
+                } else if (value == "x11") {
+                    output_backend_ = OutputBackend::X11;
+                } else if (value == "uinput") {
+                    output_backend_ = OutputBackend::Uinput;
+                } else {
+                    valid = false;
+                }
+                break;
+            case Setting::StickDeadZoneShape:
+                valid = enumFromName(kDeadZoneShapes, value, stick.dead_zone_shape);
+                break;
+            case Setting::StickDeadZone:
+                valid = parseFraction(value, 0.5f, stick.dead_zone);
+                break;
+            case Setting::StickOuterDeadZone:
+                valid = parseFraction(value, 0.5f, stick.outer_dead_zone);
+                break;
+            case Setting::StickCurve:
+                valid = enumFromName(kResponseCurves, value, stick.curve);
+                break;
+            case Setting::StickCurveExponent: {
+                float exponent = 0.0f;
+                valid = parseFloat(value, exponent) && exponent > 0.0f && exponent <= 10.0f;
+                if (valid) stick.curve_exponent = exponent;
+                break;
+            }
+            case Setting::StickCurvePoints:
+                valid = parseCurvePoints(value, stick);
+                break;
+            case Setting::PointerAccelMaxGain: {
+                float gain = 0.0f;
+                valid = parseFloat(value, gain) && gain >= 1.0f && gain <= 10.0f;
+                if (valid) pointer_acceleration_.max_gain = gain;
+                break;
+            }
+            case Setting::PointerAccelRampMs: {
+                int ramp = 0;
+                valid = parseInt(value, ramp) && ramp >= 1 && ramp <= 10000;
+                if (valid) pointer_acceleration_.ramp_ms = ramp;
+                break;
+            }
+            case Setting::PointerAccelThreshold:
+                valid = parseFraction(value, 1.0f, pointer_acceleration_.threshold);
+                break;
+            case Setting::PointerPrecisionTrigger:
+                valid = enumFromName(kPrecisionTriggers, value, pointer_acceleration_.precision_trigger);
+                break;
+            case Setting::PointerPrecisionGain: {
+                float gain = 0.0f;
+                valid = parseFloat(value, gain) && gain > 0.0f && gain <= 1.0f;
+                if (valid) pointer_acceleration_.precision_gain = gain;
+                break;
+            }
+            case Setting::GyroPointer:
+                valid = parseBool(value, gyro_.enabled);
+                break;
+            case Setting::GyroSensitivity: {
+                float sensitivity = 0.0f;
+                valid = parseFloat(value, sensitivity) && sensitivity > 0.0f && sensitivity <= 200.0f;
+                if (valid) gyro_.sensitivity = sensitivity;
+                break;
+            }
+            case Setting::GyroSmoothing: {
+                float smoothing = 0.0f;
+                valid = parseFloat(value, smoothing) && smoothing >= 0.0f && smoothing <= 100.0f;
+                if (valid) gyro_.smoothing = smoothing;
+                break;
+            }
+            case Setting::HoldTimeMs:
+                valid = parseMilliseconds(value, 5000, gestures_.hold_ms);
+                break;
+            case Setting::DoubleTapMs:
+                valid = parseMilliseconds(value, 2000, gestures_.double_tap_ms);
+                break;
+            case Setting::ChordWindowMs:
+                valid = parseMilliseconds(value, 1000, gestures_.chord_window_ms);
+                break;
+        }
+        if (!valid) {
+            addDiagnostic(line_number, value_column, "invalid value " + quoted(value) + " for " + std::string(key));
+        }
+        return;
+    }
+    
+    if (key.substr(0, 6) == "macro.") {
+        std::string_view name = key.substr(6);
+        std::string_view bad_step;
+        CompiledMacro compiled;
+        if (!validName(name)) {
+            addDiagnostic(line_number, key_column + 6, "invalid macro name " + quoted(name));
+        } else if (!compileMacro(value, compiled, bad_step)) {
+            if (compiled.count == kMaxMacroEvents) {
+                addDiagnostic(line_number, value_column,
+                              "macro has more than " + std::to_string(kMaxMacroEvents) + " events");
+            } else {
+                addDiagnostic(line_number, columnOf(line, bad_step), "invalid macro step " + quoted(bad_step));
+            }
+        } else {
+            size_t index = macroIndex(name);
+            if (index == kMaxMacros) {
+                addDiagnostic(line_number, key_column, "too many macros (at most " + std::to_string(kMaxMacros) + ")");
+            } else {
+                defineMacro(index, value, std::span<const MacroEvent>(compiled.events.data(), compiled.count));
+            }
+        }
+        return;
+    }
+    
+    GamepadButton button;
+    if (buttonFromName(key, button)) {
+        parseBinding(value, line_number, value_column, button_mappings_[static_cast<size_t>(button)]);
+        return;
+    }
+    
+    if (!parseLayerSetting(key, value, line_number, key_column, value_column) &&
+        !parseGestureSetting(key, value, line_number, key_column, value_column) &&
+        !parseRepeatSetting(key, value, line_number, key_column, value_column) &&
+        !parsePadSetting(key, value, line_number, key_column, value_column)) {
+        addDiagnostic(line_number, key_column, "unknown setting " + quoted(key));
+    }
+}
+
+bool ConfigManager::parsePadSetting(std::string_view key, std::string_view value, int line_number,
+                                    int key_column, int value_column) {
+    // "padN.<setting>" with N in 1..kMaxGamepads
+    if (key.size() < 6 || key.substr(0, 3) != "pad" || key[4] != '.') return false;
+    
+    size_t pad = static_cast<size_t>(key[3] - '1');
+    if (pad >= kMaxGamepads) {
+        addDiagnostic(line_number, key_column + 3,
+                      "unknown gamepad (pad1..pad" + std::to_string(kMaxGamepads) + ")");
+        return true;
+    }
+    
+    std::string_view setting = key.substr(5);
+    if (setting == "output") {
+        if (value == "shared" || value == "separate") {
+            separate_output_[pad] = (value == "separate");
+        } else {
+            addDiagnostic(line_number, value_column, "invalid value " + quoted(value) + " for padN.output");
+        }
+        return true;
+    }
+    
+    GamepadButton button;
+    ButtonBinding binding;
+    if (!buttonFromName(setting, button)) {
+        addDiagnostic(line_number, key_column + 5, "unknown button " + quoted(setting));
+    } else if (parseBinding(value, line_number, value_column, binding)) {
+        pad_button_mappings_[pad][static_cast<size_t>(button)] = binding;
+    }
+    return true;
+}
+
+bool ConfigManager::parseGestureSetting(std::string_view key, std::string_view value, int line_number,
+                                        int key_column, int value_column) {
+    size_t dot = key.find('.');
+    std::string_view kind = key.substr(0, dot);
+    if (dot == std::string_view::npos || (kind != "chord" && kind != "hold" && kind != "double_tap")) {
+        return false;
+    }
+    
+    // One button, or for a chord two or more joined by '+'
+    std::string_view names = key.substr(dot + 1);
+    int names_column = key_column + static_cast<int>(dot) + 1;
+    ButtonMask buttons = 0;
+    GamepadButton button = GamepadButton::A;
+    while (true) {
+        size_t plus = names.find('+');
+        std::string_view name = names.substr(0, plus);
+        if (!buttonFromName(name, button)) {
+            addDiagnostic(line_number, names_column, "unknown button " + quoted(name));
+            return true;
+        }
+        buttons |= buttonBit(button);
+        if (plus == std::string_view::npos) break;
+        names = names.substr(plus + 1);
+        names_column += static_cast<int>(plus) + 1;
+    }
+    
+    bool chord = kind == "chord";
+    if (chord != (std::popcount(buttons) > 1)) {
+        addDiagnostic(line_number, key_column, chord ? "a chord needs two or more different buttons"
+                                                     : "expected one button after " + std::string(kind) + ".");
+        return true;
+    }
+    
+    ButtonBinding binding;
+    if (!parseBinding(value, line_number, value_column, binding)) return true;
+    
+    if (kind == "hold") {
+        gestures_.hold[static_cast<size_t>(button)] = binding;
+    } else if (kind == "double_tap") {
+        gestures_.double_tap[static_cast<size_t>(button)] = binding;
+    } else {
+        // Redefining a chord replaces it; "none" removes it
+        auto begin = gestures_.chords.begin();
+        auto end = begin + gestures_.chord_count;
+        auto existing = std::find_if(begin, end, [&](const ChordBinding& entry) { return entry.buttons == buttons; });
+        if (binding.action == ButtonAction::Unmapped) {
+            if (existing != end) {
+                std::move(existing + 1, end, existing);
+                gestures_.chords[--gestures_.chord_count] = ChordBinding{};
+            }
+        } else if (existing != end) {
+            existing->binding = binding;
+        } else if (gestures_.chord_count == kMaxChords) {
+            addDiagnostic(line_number, key_column, "too many chords (at most " + std::to_string(kMaxChords) + ")");
+        } else {
+            gestures_.chords[gestures_.chord_count++] = {buttons, binding};
+        }
+    }
+    return true;
+}
+
+bool ConfigManager::parseLayerSetting(std::string_view key, std::string_view value, int line_number,
+                                      int key_column, int value_column) {
+    if (key.substr(0, 6) != "layer.") return false;
     
-    size_t pos = line.find('=');
-    if (pos == std::string::npos) return;
+    // "layer.<name>" or "layer.<name>.<setting>"
+    std::string_view rest = key.substr(6);
+    size_t dot = rest.find('.');
+    std::string_view name = rest.substr(0, dot);
+    if (!validName(name)) {
+        addDiagnostic(line_number, key_column + 6, "invalid layer name " + quoted(name));
+        return true;
+    }
+    size_t index = layerIndex(name);
+    if (index == kMaxLayers) {
+        addDiagnostic(line_number, key_column, "too many layers (at most " + std::to_string(kMaxLayers - 1) + ")");
+        return true;
+    }
+    LayerDefinition& layer = layers_[index];
+    if (layer.reference_line == 0) {
+        layer.reference_line = line_number;
+        layer.reference_column = key_column + 6;
+    }
+    
+    GamepadButton button;
+    if (dot == std::string_view::npos) {
+        // One layer per modifier, so a held button always means one layer
+        if (!buttonFromName(value, button)) {
+            addDiagnostic(line_number, value_column, "unknown button " + quoted(value));
+            return true;
+        }
+        for (const auto& other : layers_) {
+            if (other.modifier == button && other.name != name) {
+                addDiagnostic(line_number, value_column,
+                              quoted(value) + " already switches to layer " + quoted(other.name));
+                return true;
+            }
+        }
+        layer.modifier = button;
+        return true;
+    }
     
-    std::string key = trim(line.substr(0, pos));
-    std::string value = trim(line.substr(pos + 1));
+    std::string_view setting = rest.substr(dot + 1);
+    int setting_column = key_column + 6 + static_cast<int>(dot) + 1;
+    if (setting == "left_stick" || setting == "right_stick") {
+        StickRole& role = layer.sticks[setting == "left_stick" ? 0 : 1];
+        if (!enumFromName(kStickRoles, value, role)) {
+            addDiagnostic(line_number, value_column, "invalid value " + quoted(value) + " for " + std::string(key));
+        }
+        return true;
+    }
+    
+    ButtonBinding binding;
+    if (!buttonFromName(setting, button)) {
+        addDiagnostic(line_number, setting_column, "unknown button " + quoted(setting));
+    } else if (parseBinding(value, line_number, value_column, binding)) {
+        layer.buttons[static_cast<size_t>(button)] = binding;
+    }
+    return true;
+}
+
+bool ConfigManager::parseRepeatSetting(std::string_view key, std::string_view value, int line_number,
+                                       int key_column, int value_column) {
+    size_t dot = key.find('.');
+    std::string_view kind = key.substr(0, dot);
+    if (dot == std::string_view::npos || (kind != "repeat" && kind != "turbo")) return false;
+    
+    GamepadButton button;
+    std::string_view name = key.substr(dot + 1);
+    if (!buttonFromName(name, button)) {
+        addDiagnostic(line_number, key_column + static_cast<int>(dot) + 1, "unknown button " + quoted(name));
+        return true;
+    }
     
-    // Parse sensitivity settings
-    if (key == "mouse_sensitivity") {
-        mouse_sensitivity_ = std::stof(value);
-    } else if (key == "scroll_sensitivity") {
-        scroll_sensitivity_ = std::stof(value);
-    } else if (key == "invert_scroll") {
-        invert_scroll_ = (value == "true" || value == "1");
+    // "<delay_ms>, <per_second>" for repeat, "<per_second>" for turbo,
+    // "none" for neither
+    RepeatSettings repeat;
+    bool valid = true;
+    if (value != "none") {
+        std::string_view rate = value;
+        if (kind == "repeat") {
+            size_t comma = value.find(',');
+            int delay = 0;
+            valid = comma != std::string_view::npos && parseInt(trimView(value.substr(0, comma)), delay) &&
+                    delay >= 1 && delay <= 5000;
+            repeat.delay_ms = static_cast<uint32_t>(delay);
+            rate = comma != std::string_view::npos ? trimView(value.substr(comma + 1)) : std::string_view();
+        }
+        int per_second = 0;
+        valid = valid && parseInt(rate, per_second) && per_second >= 1 && per_second <= 100;
+        repeat.rate_hz = static_cast<uint32_t>(per_second);
+        repeat.turbo = kind == "turbo";
+    }
+    
+    if (valid) {
+        repeats_[static_cast<size_t>(button)] = repeat;
     } else {
-        // Assume it's a button mapping
-        button_mappings_[key] = value;
+        addDiagnostic(line_number, value_column, "invalid value " + quoted(value) + " for " + std::string(key));
+    }
+    return true;
+}
+
+bool ConfigManager::parseBinding(std::string_view value, int line_number, int value_column, ButtonBinding& binding) {
+    if (value.substr(0, 6) == "macro:") {
+        std::string_view name = value.substr(6);
+        size_t index = validName(name) ? macroIndex(name) : kMaxMacros;
+        if (!validName(name)) {
+            addDiagnostic(line_number, value_column + 6, "invalid macro name " + quoted(name));
+            return false;
+        }
+        if (index == kMaxMacros) {
+            addDiagnostic(line_number, value_column, "too many macros (at most " + std::to_string(kMaxMacros) + ")");
+            return false;
+        }
+        if (macros_[index].reference_line == 0) {
+            macros_[index].reference_line = line_number;
+            macros_[index].reference_column = value_column + 6;
+        }
+        binding = ButtonBinding{ButtonAction::Macro, static_cast<uint8_t>(index)};
+        return true;
+    }
+    
+    // A bare "macro" has nothing to play
+    ButtonAction action;
+    if (!actionFromName(value, action) || action == ButtonAction::Macro) {
+        addDiagnostic(line_number, value_column, "unknown action " + quoted(value));
+        return false;
+    }
+    binding = ButtonBinding{action};
+    return true;
+}
+
+size_t ConfigManager::macroIndex(std::string_view name) {
+    for (size_t index = 0; index < macros_.size(); ++index) {
+        if (macros_[index].name == name) return index;
     }
+    if (macros_.size() == kMaxMacros) return kMaxMacros;
+    
+    MacroDefinition macro;
+    macro.name = name;
+    macros_.push_back(std::move(macro));
+    return macros_.size() - 1;
 }
 
-std::string ConfigManager::trim(const std::string& str) {
-    size_t first = str.find_first_not_of(" \t\r\n");
-    size_t last = str.find_last_not_of(" \t\r\n");
-    if (first == std::string::npos) return "";
-    return str.substr(first, last - first + 1);
+size_t ConfigManager::layerIndex(std::string_view name) {
+    for (size_t index = 0; index < layers_.size(); ++index) {
+        if (layers_[index].name == name) return index;
+    }
+    if (layers_.size() == kMaxLayers - 1) return kMaxLayers;
+    
+    LayerDefinition layer;
+    layer.name = name;
+    layers_.push_back(std::move(layer));
+    return layers_.size() - 1;
+}
+
+void ConfigManager::defineMacro(size_t index, std::string_view steps, std::span<const MacroEvent> events) {
+    MacroDefinition& macro = macros_[index];
+    macro.steps = steps;
+    macro.first_event = static_cast<uint32_t>(macro_events_.size());
+    macro.event_count = static_cast<uint32_t>(events.size());
+    macro.defined = true;
+    macro_events_.insert(macro_events_.end(), events.begin(), events.end());
+}
+
+std::string ConfigManager::bindingName(const ButtonBinding& binding) const {
+    // "none" for an unbound button, so the saved file round-trips
+    if (binding.action == ButtonAction::Unmapped) return "none";
+    if (binding.action == ButtonAction::Macro) return std::string("macro:") + getMacroName(binding.macro);
+    return actionName(binding.action);
+}
+
+void ConfigManager::addDiagnostic(int line_number, int column, std::string message) {
+    diagnostics_.push_back({line_number, column, std::move(message)});
 }
 
 float ConfigManager::getMouseSensitivity() const {
@@ -128,30 +1181,179 @@ float ConfigManager::getScrollSensitivity() const {
     return scroll_sensitivity_;
 }
 
+bool ConfigManager::operator==(const ConfigManager& other) const {
+    // binding_tables_ and macro_events_ are compiled from the mappings and
+    // macro steps, so they needn't be compared
+    return mouse_sensitivity_ == other.mouse_sensitivity_
+        && scroll_sensitivity_ == other.scroll_sensitivity_
+        && invert_scroll_ == other.invert_scroll_
+        && loop_mode_ == other.loop_mode_
+        && poll_interval_ms_ == other.poll_interval_ms_
+        && output_backend_ == other.output_backend_
+        && button_mappings_ == other.button_mappings_
+        && pad_button_mappings_ == other.pad_button_mappings_
+        && macros_ == other.macros_
+        && separate_output_ == other.separate_output_
+        && stick_settings_ == other.stick_settings_
+        && pointer_acceleration_ == other.pointer_acceleration_
+        && gyro_ == other.gyro_
+        && gestures_ == other.gestures_
+        && repeats_ == other.repeats_
+        && layers_ == other.layers_;
+}
+
+int ConfigManager::getParseErrorCount() const {
+    return static_cast<int>(diagnostics_.size());
+}
+
+const std::vector<ConfigDiagnostic>& ConfigManager::getDiagnostics() const {
+    return diagnostics_;
+}
+
 bool ConfigManager::getInvertScroll() const {
     return invert_scroll_;
 }
 
-std::string ConfigManager::getButtonAction(const std::string& button) const {
-    auto it = button_mappings_.find(button);
-    if (it != button_mappings_.end()) {
-        return it->second;
-    }
-    return "";
+LoopMode ConfigManager::getLoopMode() const {
+    return loop_mode_;
+}
+
+int ConfigManager::getPollIntervalMs() const {
+    return poll_interval_ms_;
+}
+
+OutputBackend ConfigManager::getOutputBackend() const {
+    return output_backend_;
+}
+
+const char* ConfigManager::getButtonAction(std::string_view button) const {
+    GamepadButton parsed;
+    if (!buttonFromName(button, parsed)) return "";
+    return actionName(button_mappings_[static_cast<size_t>(parsed)].action);
 }
 
 void ConfigManager::setMouseSensitivity(float value) {
-    mouse_sensitivity_ = std::max(0.2f, std::min(5.0f, value));
+    mouse_sensitivity_ = std::clamp(value, kMinSensitivity, kMaxSensitivity);
 }
 
 void ConfigManager::setScrollSensitivity(float value) {
-    scroll_sensitivity_ = std::max(0.2f, std::min(5.0f, value));
+    scroll_sensitivity_ = std::clamp(value, kMinSensitivity, kMaxSensitivity);
 }
 
 void ConfigManager::setInvertScroll(bool value) {
     invert_scroll_ = value;
 }
 
-void ConfigManager::setButtonAction(const std::string& button, const std::string& action) {
-    button_mappings_[button] = action;
+void ConfigManager::setLoopMode(LoopMode mode) {
+    loop_mode_ = mode;
+}
+
+void ConfigManager::setPollIntervalMs(int value) {
+    poll_interval_ms_ = std::max(1, std::min(100, value));
+}
+
+void ConfigManager::setOutputBackend(OutputBackend backend) {
+    output_backend_ = backend;
+}
+
+void ConfigManager::setButtonAction(GamepadButton button, ButtonAction action) {
+    button_mappings_[static_cast<size_t>(button)] = ButtonBinding{action};
+    compileButtonMappings();
+}
+
+void ConfigManager::setPadButtonAction(size_t pad, GamepadButton button, ButtonAction action) {
+    if (pad >= kMaxGamepads) return;
+    pad_button_mappings_[pad][static_cast<size_t>(button)] = ButtonBinding{action};
+    compileButtonMappings();
+}
+
+std::span<const MacroEvent> ConfigManager::getMacroEvents(uint8_t macro) const {
+    if (macro >= macros_.size()) return {};
+    const MacroDefinition& definition = macros_[macro];
+    return std::span<const MacroEvent>(macro_events_).subspan(definition.first_event, definition.event_count);
+}
+
+const char* ConfigManager::getMacroName(uint8_t macro) const {
+    return macro < macros_.size() ? macros_[macro].name.c_str() : "";
+}
+
+bool ConfigManager::setMacro(std::string_view name, std::string_view steps) {
+    CompiledMacro compiled;
+    std::string_view bad_step;
+    if (!validName(name) || !compileMacro(steps, compiled, bad_step)) return false;
+    size_t index = macroIndex(name);
+    if (index == kMaxMacros) return false;
+    
+    defineMacro(index, steps, std::span<const MacroEvent>(compiled.events.data(), compiled.count));
+    return true;
+}
+
+void ConfigManager::setGestures(const GestureTable& gestures) {
+    gestures_ = gestures;
+    gestures_.compile();
+}
+
+void ConfigManager::setRepeat(GamepadButton button, const RepeatSettings& repeat) {
+    repeats_[static_cast<size_t>(button)] = repeat;
+}
+
+const char* ConfigManager::getLayerName(size_t layer) const {
+    if (layer == 0) return "base";
+    return layer <= layers_.size() ? layers_[layer - 1].name.c_str() : "";
+}
+
+bool ConfigManager::setLayer(const LayerDefinition& layer) {
+    if (!validName(layer.name)) return false;
+    for (const auto& other : layers_) {
+        if (other.name != layer.name && other.modifier == layer.modifier && layer.modifier != GamepadButton::Count) {
+            return false;
+        }
+    }
+    size_t index = layerIndex(layer.name);
+    if (index == kMaxLayers) return false;
+    
+    layers_[index] = layer;
+    compileButtonMappings();
+    return true;
+}
+
+void ConfigManager::setButtonMacro(GamepadButton button, std::string_view macro) {
+    size_t index = validName(macro) ? macroIndex(macro) : kMaxMacros;
+    if (index == kMaxMacros) return;
+    button_mappings_[static_cast<size_t>(button)] = ButtonBinding{ButtonAction::Macro, static_cast<uint8_t>(index)};
+    compileButtonMappings();
+}
+
+const PointerAcceleration& ConfigManager::getPointerAcceleration() const {
+    return pointer_acceleration_;
+}
+
+void ConfigManager::setPointerAcceleration(const PointerAcceleration& acceleration) {
+    pointer_acceleration_ = acceleration;
+}
+
+const GyroSettings& ConfigManager::getGyro() const {
+    return gyro_;
+}
+
+void ConfigManager::setGyro(const GyroSettings& gyro) {
+    gyro_ = gyro;
+}
+
+const StickSettings& ConfigManager::getStickSettings(GamepadStick stick) const {
+    return stick_settings_[static_cast<size_t>(stick)];
+}
+
+void ConfigManager::setStickSettings(GamepadStick stick, const StickSettings& settings) {
+    stick_settings_[static_cast<size_t>(stick)] = settings;
+}
+
+bool ConfigManager::getSeparateOutput(size_t pad) const {
+    return pad < kMaxGamepads && separate_output_[pad];
+}
+
+void ConfigManager::setSeparateOutput(size_t pad, bool separate) {
+    if (pad < kMaxGamepads) {
+        separate_output_[pad] = separate;
+    }
 }
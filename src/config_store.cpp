@@ -0,0 +1,61 @@
+#include "config_store.h"
+#include <algorithm>
+
+ConfigStore::ConfigStore()
+    : current_(nullptr)
+    , reader_epoch_(0)
+{
+}
+
+ConfigStore::~ConfigStore() {
+    // No reader is left by now
+    delete current_.load();
+    for (const auto& retired : retired_) {
+        delete retired.snapshot;
+    }
+}
+
+const ConfigManager* ConfigStore::acquire() {
+    // Quiescent point: whatever the previous frame used is released here.
+    // Both operations are seq_cst so a writer that swapped before reading
+    // the epoch is guaranteed to be seen by the load below.
+    reader_epoch_.fetch_add(1);
+    return current_.load();
+}
+
+void ConfigStore::publish(std::unique_ptr<const ConfigManager> snapshot) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    swapLocked(snapshot.release());
+}
+
+bool ConfigStore::publishIfChanged(std::unique_ptr<const ConfigManager> snapshot) {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    // Only writers replace or free current_, so it is safe to read under the lock
+    const ConfigManager* current = current_.load();
+    if (current && *current == *snapshot) {
+        return false;
+    }
+    swapLocked(snapshot.release());
+    return true;
+}
+
+std::unique_ptr<ConfigManager> ConfigStore::copyCurrent() const {
+    std::lock_guard<std::mutex> lock(writer_mutex_);
+    const ConfigManager* current = current_.load();
+    return current ? std::make_unique<ConfigManager>(*current) : std::make_unique<ConfigManager>();
+}
+
+void ConfigStore::swapLocked(const ConfigManager* snapshot) {
+    const ConfigManager* old = current_.exchange(snapshot);
+    if (old) {
+        // The reader may still hold it until its next acquire()
+        retired_.push_back({old, reader_epoch_.load()});
+    }
+    
+    uint64_t epoch = reader_epoch_.load();
+    auto reclaimable = [epoch](const Retired& retired) { return retired.reader_epoch < epoch; };
+    for (const auto& retired : retired_) {
+        if (reclaimable(retired)) delete retired.snapshot;
+    }
+    retired_.erase(std::remove_if(retired_.begin(), retired_.end(), reclaimable), retired_.end());
+}
@@ -0,0 +1,137 @@
+#include "config_watcher.h"
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// How often the loop checks for stop() while idle
+constexpr int kWakeIntervalMs = 250;
+// Editors often write a file in several steps; wait for this much quiet
+// before re-parsing
+constexpr int kSettleMs = 50;
+
+} // namespace
+
+ConfigWatcher::ConfigWatcher()
+    : store_(nullptr)
+    , running_(false)
+#ifdef __linux__
+    , inotify_fd_(-1)
+#endif
+{
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    stop();
+}
+
+bool ConfigWatcher::start(const std::string& path, ConfigStore& store) {
+    if (running_) return true;
+    
+    path_ = path;
+    store_ = &store;
+
+#ifdef __linux__
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    if (directory.empty()) directory = ".";
+    
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0 ||
+        inotify_add_watch(inotify_fd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cerr << "Cannot watch config directory: " << directory << std::endl;
+        if (inotify_fd_ >= 0) close(inotify_fd_);
+        inotify_fd_ = -1;
+        return false;
+    }
+#endif
+
+    running_ = true;
+    worker_ = std::thread(&ConfigWatcher::watchLoop, this);
+    std::cout << "Watching " << path_ << " for changes" << std::endl;
+    return true;
+}
+
+void ConfigWatcher::stop() {
+    if (!running_.exchange(false)) return;
+    
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+#ifdef __linux__
+    close(inotify_fd_);
+    inotify_fd_ = -1;
+#endif
+}
+
+#ifdef __linux__
+void ConfigWatcher::watchLoop() {
+    std::string filename = std::filesystem::path(path_).filename().string();
+    alignas(inotify_event) char buffer[4096];
+    bool pending = false;
+    
+    while (running_) {
+        pollfd descriptor{inotify_fd_, POLLIN, 0};
+        int ready = poll(&descriptor, 1, pending ? kSettleMs : kWakeIntervalMs);
+        if (ready == 0) {
+            // Quiet again after a change to our file
+            if (pending) {
+                pending = false;
+                reload();
+            }
+            continue;
+        }
+        if (ready < 0) continue;
+        
+        ssize_t length;
+        while ((length = read(inotify_fd_, buffer, sizeof(buffer))) > 0) {
+            for (char* cursor = buffer; cursor < buffer + length;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(cursor);
+                if (event->len > 0 && filename == event->name) {
+                    pending = true;
+                }
+                cursor += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+}
+#else
+void ConfigWatcher::watchLoop() {
+    std::error_code error;
+    auto last_write = std::filesystem::last_write_time(path_, error);
+    int waited_ms = 0;
+    
+    while (running_) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(kWakeIntervalMs));
+        waited_ms += kWakeIntervalMs;
+        if (waited_ms < 1000) continue;
+        waited_ms = 0;
+        
+        auto write_time = std::filesystem::last_write_time(path_, error);
+        if (!error && write_time != last_write) {
+            last_write = write_time;
+            // Let a save in progress finish
+            std::this_thread::sleep_for(std::chrono::milliseconds(kSettleMs));
+            reload();
+        }
+    }
+}
+#endif
+
+void ConfigWatcher::reload() {
+    auto config = std::make_unique<ConfigManager>();
+    if (!config->loadConfig(path_)) {
+        std::cerr << "Config reload failed, keeping the previous settings" << std::endl;
+        return;
+    }
+    
+    if (store_->publishIfChanged(std::move(config))) {
+        std::cout << "Config reloaded: " << path_ << std::endl;
+    }
+}
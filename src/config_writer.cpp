@@ -0,0 +1,66 @@
+#include "config_writer.h"
+#include <utility>
+
+ConfigWriter::ConfigWriter()
+    : running_(false)
+{
+}
+
+ConfigWriter::~ConfigWriter() {
+    stop();
+}
+
+bool ConfigWriter::start(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return true;
+    
+    path_ = path;
+    running_ = true;
+    worker_ = std::thread(&ConfigWriter::workerLoop, this);
+    return true;
+}
+
+void ConfigWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    wake_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+bool ConfigWriter::post(std::unique_ptr<const ConfigManager> config) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return false;
+        
+        // A newer snapshot replaces one still waiting and restarts the wait
+        pending_ = std::move(config);
+        due_ = std::chrono::steady_clock::now() + kQuietPeriod;
+    }
+    wake_.notify_one();
+    return true;
+}
+
+void ConfigWriter::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_ || pending_) {
+        if (!pending_) {
+            wake_.wait(lock);
+            continue;
+        }
+        // On stop() the pending snapshot is written right away
+        if (running_ && std::chrono::steady_clock::now() < due_) {
+            wake_.wait_until(lock, due_);
+            continue;
+        }
+        
+        std::unique_ptr<const ConfigManager> config = std::move(pending_);
+        lock.unlock();
+        config->saveConfig(path_);
+        lock.lock();
+    }
+}
@@ -0,0 +1,833 @@
+#include "gamepad_api.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+#ifndef _WIN32
+#include <csignal>
+#endif
+
+GamepadAPI::GamepadAPI()
+    : config_(nullptr)
+    , config_path_("controller_config.txt")
+    , running_(false)
+    , mouse_sensitivity_(1.0f)
+    , scroll_sensitivity_(1.0f)
+    , invert_scroll_y_(false)
+    , loop_mode_(LoopMode::Event)
+    , poll_interval_ms_(16)
+    , wakeup_count_(0)
+    , report_event_type_(0)
+    , replay_max_speed_(false)
+{
+}
+
+void GamepadAPI::setConfigPath(const std::string& path) {
+    config_path_ = path;
+}
+
+void GamepadAPI::setRecordPath(const std::string& path) {
+    record_path_ = path;
+}
+
+void GamepadAPI::setReplayPath(const std::string& path) {
+    replay_path_ = path;
+}
+
+void GamepadAPI::setReplayMaxSpeed(bool max_speed) {
+    replay_max_speed_ = max_speed;
+}
+
+void GamepadAPI::setOutputTracePath(const std::string& path) {
+    trace_path_ = path;
+}
+
+bool GamepadAPI::initialize() {
+    if (!replay_path_.empty()) {
+        // Replay never touches the gamepad, the desktop or the media player
+        return replay_.open(replay_path_) && initializeHeadless();
+    }
+    
+    auto started = std::chrono::steady_clock::now();
+    loadSettings();
+    if (!trace_path_.empty() && !openOutputTrace()) {
+        return false;
+    }
+    
+    auto sdl_started = std::chrono::steady_clock::now();
+    if (!gamepad_.initialize()) {
+        std::cerr << "Failed to initialize gamepad controller" << std::endl;
+        return false;
+    }
+    auto sdl_init = std::chrono::steady_clock::now() - sdl_started;
+    
+    if (!initializeOutputs(config_->getOutputBackend())) {
+        std::cerr << "Failed to initialize input simulator" << std::endl;
+        return false;
+    }
+    
+    if (!media_ctrl_.initialize()) {
+        std::cerr << "Failed to initialize media controller" << std::endl;
+        return false;
+    }
+    
+    if (!config_path_.empty()) {
+        config_writer_.start(config_path_);
+        config_watcher_.start(config_path_, config_store_);
+    }
+    
+    if (!record_path_.empty()) {
+        if (!recorder_.open(record_path_)) {
+            return false;
+        }
+        gamepad_.setEventCallback([this](const SDL_Event& event) { recorder_.recordEvent(event); });
+    }
+    
+    setupCallbacks();
+    startReportSignalThread();
+    
+    // Nothing above waits for a gamepad, so this should stay at a few ms
+    // plus whatever SDL_Init takes on this system
+    auto ready = std::chrono::steady_clock::now() - started;
+    std::cout << "Ready in " << std::chrono::duration<double, std::milli>(ready).count() << " ms (SDL init "
+              << std::chrono::duration<double, std::milli>(sdl_init).count() << " ms)" << std::endl;
+    return true;
+}
+
+void GamepadAPI::run() {
+    running_ = true;
+    
+    std::cout << "Xbox Controller API started successfully!" << std::endl;
+    std::cout << "Controls:" << std::endl;
+    std::cout << "- Left stick: Mouse movement" << std::endl;
+    std::cout << "- Right stick: Scroll wheel (Y-axis " << (invert_scroll_y_ ? "inverted" : "normal") << ", X-axis horizontal)" << std::endl;
+    std::cout << "- A button: " << config_->getButtonAction("button_a") << std::endl;
+    std::cout << "- B button: " << config_->getButtonAction("button_b") << std::endl;
+    std::cout << "- X button: " << config_->getButtonAction("button_x") << std::endl;
+    std::cout << "- Y button: " << config_->getButtonAction("button_y") << std::endl;
+    std::cout << "- Left Shoulder: " << config_->getButtonAction("left_shoulder") << std::endl;
+    std::cout << "- Right Shoulder: " << config_->getButtonAction("right_shoulder") << std::endl;
+    std::cout << "- Back button: " << config_->getButtonAction("button_back") << std::endl;
+    std::cout << "- Guide button: " << config_->getButtonAction("button_guide") << std::endl;
+    std::cout << "- Left stick click: " << config_->getButtonAction("left_stick_button") << std::endl;
+    std::cout << "- Right stick click: " << config_->getButtonAction("right_stick_button") << std::endl;
+    std::cout << "- Left Trigger: " << config_->getButtonAction("left_trigger") << std::endl;
+    std::cout << "- Right Trigger: " << config_->getButtonAction("right_trigger") << std::endl;
+    std::cout << "- Start button: " << config_->getButtonAction("button_start") << std::endl;
+    std::cout << "- D-pad Up: " << config_->getButtonAction("dpad_up") << std::endl;
+    std::cout << "- D-pad Down: " << config_->getButtonAction("dpad_down") << std::endl;
+    std::cout << "- D-pad Left: " << config_->getButtonAction("dpad_left") << std::endl;
+    std::cout << "- D-pad Right: " << config_->getButtonAction("dpad_right") << std::endl;
+    std::cout << "- Loop mode: " << (loop_mode_ == LoopMode::Fixed ? "fixed" : "event")
+              << " (" << poll_interval_ms_ << " ms interval)" << std::endl;
+    std::cout << "-------------------------------" << std::endl;
+    
+    auto started = std::chrono::steady_clock::now();
+    if (!replay_path_.empty()) {
+        runReplay();
+    } else {
+        runLive();
+    }
+    
+    printLoopStats(std::chrono::steady_clock::now() - started);
+}
+
+void GamepadAPI::shutdown() {
+    running_ = false;
+    config_watcher_.stop();
+    config_writer_.stop();
+    if (recorder_.isOpen()) {
+        std::cout << "Recorded " << recorder_.frameCount() << " frames ("
+                  << recorder_.bytesWritten() << " bytes)" << std::endl;
+        recorder_.close();
+    }
+    replay_.close();
+    gamepad_.shutdown();
+    for (auto& output : outputs_) {
+        output.shutdown();
+    }
+    media_ctrl_.shutdown();
+}
+
+void GamepadAPI::setupCallbacks() {
+    // Remove callback-based approach, use state polling instead
+    gamepad_.setQuitCallback([this]() { running_ = false; });
+    gamepad_.setUserEventCallback([this](const SDL_UserEvent& event) {
+        if (report_event_type_ != 0 && event.type == report_event_type_) {
+            printLatencyReport();
+        }
+    });
+}
+
+void GamepadAPI::startReportSignalThread() {
+#ifndef _WIN32
+    report_event_type_ = SDL_RegisterEvents(1);
+    if (report_event_type_ == 0) return;
+    
+    uint32_t event_type = report_event_type_;
+    std::thread([event_type]() {
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigaddset(&signals, SIGUSR1);
+        int signal_number = 0;
+        while (sigwait(&signals, &signal_number) == 0) {
+            SDL_Event event{};
+            event.type = event_type;
+            SDL_PushEvent(&event);
+        }
+    }).detach();
+    std::cout << "Send SIGUSR1 to print latency statistics" << std::endl;
+#endif
+}
+
+void GamepadAPI::runLive() {
+    while (running_) {
+        // A playing macro, a pending gesture or a repeat wakes the loop
+        // when due
+        int64_t timer_due_ns = nanosecondsUntilNextTimer();
+        if (loop_mode_ == LoopMode::Fixed) {
+            gamepad_.update();
+            processLiveFrame();
+            std::chrono::nanoseconds interval = std::chrono::milliseconds(poll_interval_ms_);
+            if (timer_due_ns >= 0) {
+                interval = std::min(interval, std::chrono::nanoseconds(timer_due_ns));
+            }
+            std::this_thread::sleep_for(interval);
+        } else {
+            // Only continuous stick motion needs a periodic tick; otherwise
+            // sleep until SDL delivers the next event
+            int timeout_ms = needsContinuousUpdate() ? poll_interval_ms_ : -1;
+            if (timer_due_ns >= 0) {
+                // SDL waits in whole ms; round up so a timer is never early
+                int timer_due_ms = static_cast<int>((timer_due_ns + 999999) / 1000000);
+                timeout_ms = timeout_ms < 0 ? timer_due_ms : std::min(timeout_ms, timer_due_ms);
+            }
+            gamepad_.waitForEvents(timeout_ms);
+            processLiveFrame();
+        }
+        ++wakeup_count_;
+    }
+}
+
+bool GamepadAPI::initializeHeadless() {
+    loadSettings();
+    if (!trace_path_.empty() && !openOutputTrace()) {
+        return false;
+    }
+    
+    return initializeOutputs(OutputBackend::Null);
+}
+
+void GamepadAPI::processFrame(const GamepadState& state, size_t pad, const SensorReadings& sensors) {
+    refreshConfig();
+    processGamepadInput(pad, state, sensors);
+    advanceTimers(state.poll_timestamp_ns);
+    pads_[pad].output->flush();
+}
+
+InputSimulator& GamepadAPI::getInputSimulator() {
+    return outputs_[0];
+}
+
+bool GamepadAPI::initializeOutputs(OutputBackend backend) {
+    outputs_[0].setBackend(backend);
+    if (!outputs_[0].initialize()) {
+        return false;
+    }
+    
+    for (size_t slot = 0; slot < kMaxGamepads; ++slot) {
+        pads_[slot].output = &outputs_[0];
+        if (slot == 0 || !config_->getSeparateOutput(slot)) continue;
+        
+        // A separate output is its own virtual device (uinput); XTest and
+        // SendInput still drive the one system cursor
+        InputSimulator& output = outputs_[slot];
+        output.setBackend(backend);
+        output.setDeviceName("Gamepad Desktop Bridge (pad" + std::to_string(slot + 1) + ")");
+        if (!output.initialize()) {
+            std::cerr << "pad" << slot + 1 << ": separate output unavailable, sharing pad1's" << std::endl;
+            continue;
+        }
+        pads_[slot].output = &output;
+    }
+    return true;
+}
+
+void GamepadAPI::applyMotionSpeeds() {
+    for (auto& pad : pads_) {
+        pad.pointer_motion.setSpeed(kBasePointerSpeed * mouse_sensitivity_);
+        pad.scroll_motion.setSpeed(kBaseScrollSpeed * scroll_sensitivity_);
+    }
+}
+
+void GamepadAPI::loadSettings() {
+    auto config = std::make_unique<ConfigManager>();
+    if (!config_path_.empty()) {
+        config->loadConfig(config_path_);
+        // Create the file or add settings it lacks; a file with errors is
+        // left alone rather than rewritten without the lines we couldn't read
+        if (config->getParseErrorCount() == 0) {
+            config->saveConfig(config_path_);
+        }
+    }
+    config_store_.publish(std::move(config));
+    refreshConfig();
+}
+
+void GamepadAPI::updateSettings(const std::function<void(ConfigManager&)>& edit) {
+    auto config = config_store_.copyCurrent();
+    edit(*config);
+    config_writer_.post(std::make_unique<ConfigManager>(*config));
+    config_store_.publish(std::move(config));
+    
+    // The frame still reads bindings and gestures from the snapshot it
+    // acquired, so the new one is only picked up by the next frame's
+    // refreshConfig(); the mirrored sensitivities apply right away
+    applyMotionSpeeds();
+}
+
+void GamepadAPI::refreshConfig() {
+    const ConfigManager* snapshot = config_store_.acquire();
+    if (snapshot == config_) return;
+    config_ = snapshot;
+    
+    // Load sensitivity settings from config. Output backend and separate
+    // outputs are only read by initialize() and need a restart.
+    mouse_sensitivity_ = config_->getMouseSensitivity();
+    scroll_sensitivity_ = config_->getScrollSensitivity();
+    applyMotionSpeeds();
+    invert_scroll_y_ = config_->getInvertScroll();
+    loop_mode_ = config_->getLoopMode();
+    poll_interval_ms_ = config_->getPollIntervalMs();
+    for (size_t stick = 0; stick < kGamepadStickCount; ++stick) {
+        stick_responses_[stick].configure(config_->getStickSettings(static_cast<GamepadStick>(stick)));
+    }
+    for (auto& pad : pads_) {
+        pad.pointer_motion.setAcceleration(config_->getPointerAcceleration());
+        pad.gyro_motion.configure(config_->getGyro());
+    }
+    // Sensor readings wake the loop, so they are only on while used
+    gamepad_.setSensorsEnabled(config_->getGyro().enabled);
+    // Layer indices and modifiers may have changed with the config
+    for (size_t slot = 0; slot < kMaxGamepads; ++slot) {
+        updateLayer(slot, pads_[slot].prev_buttons, 0);
+    }
+}
+
+void GamepadAPI::processLiveFrame() {
+    refreshConfig();
+    for (size_t slot = 0; slot < kMaxGamepads; ++slot) {
+        bool connected = gamepad_.isConnected(slot);
+        if (!connected && !pads_[slot].connected) continue;
+        
+        // A pad unplugged since the last frame gets one more: its slot reads
+        // as all released, so held clicks are let go
+        pads_[slot].connected = connected;
+        if (!connected) {
+            pads_[slot].gyro_motion.reset();
+        }
+        GamepadState state = gamepad_.getState(slot);
+        SensorReadings sensors = gamepad_.getSensorReadings(slot);
+        if (recorder_.isOpen()) {
+            recorder_.recordFrame(state, slot, sensors);
+        }
+        processGamepadInput(slot, state, sensors);
+    }
+    advanceTimers(SDL_GetTicksNS());
+    flushOutput();
+}
+
+void GamepadAPI::runReplay() {
+    GamepadState state;
+    size_t pad = 0;
+    uint64_t first_timestamp_ns = 0;
+    bool first = true;
+    auto started = std::chrono::steady_clock::now();
+    
+    while (running_ && replay_.nextFrame(state, pad)) {
+        if (first) {
+            first_timestamp_ns = state.poll_timestamp_ns;
+            first = false;
+        }
+        if (!replay_max_speed_) {
+            std::this_thread::sleep_until(
+                started + std::chrono::nanoseconds(state.poll_timestamp_ns - first_timestamp_ns));
+        }
+        processFrame(state, pad, replay_.sensorReadings());
+        ++wakeup_count_;
+    }
+    
+    if (replay_.isCorrupt()) {
+        std::cerr << "Recording is truncated or corrupt; replay stopped early" << std::endl;
+    }
+    std::cout << "Replayed " << wakeup_count_ << " frames and "
+              << replay_.eventCount() << " recorded events" << std::endl;
+    running_ = false;
+}
+
+bool GamepadAPI::openOutputTrace() {
+    output_trace_.open(trace_path_);
+    if (!output_trace_.is_open()) {
+        std::cerr << "Cannot create output trace: " << trace_path_ << std::endl;
+        return false;
+    }
+    
+    // "<frame> <output> <command> <args>", stable across builds so traces can
+    // be diffed
+    for (size_t index = 0; index < outputs_.size(); ++index) {
+        outputs_[index].setOutputObserver([this, index](const OutputBuffer& batch) {
+            static const char* const kButtonNames[] = {"left", "right", "middle"};
+            for (const auto& command : batch) {
+                output_trace_ << wakeup_count_ << ' ' << index << ' ';
+                switch (command.type) {
+                    case OutputCommandType::MouseMove:
+                        output_trace_ << "move " << command.x << ' ' << command.y;
+                        break;
+                    case OutputCommandType::MouseWarp:
+                        output_trace_ << "warp " << command.x << ' ' << command.y;
+                        break;
+                    case OutputCommandType::MouseButton:
+                        output_trace_ << "button " << kButtonNames[static_cast<int>(command.button)]
+                                      << (command.down ? " down" : " up");
+                        break;
+                    case OutputCommandType::Scroll:
+                        output_trace_ << "scroll " << command.x << ' ' << command.y;
+                        break;
+                    case OutputCommandType::Key:
+                        output_trace_ << "key " << command.x << (command.down ? " down" : " up");
+                        break;
+                }
+                output_trace_ << '\n';
+            }
+        });
+    }
+    return true;
+}
+
+void GamepadAPI::flushOutput() {
+    uint64_t dispatched = SDL_GetTicksNS();
+    uint64_t events = 0;
+    for (auto& output : outputs_) {
+        output.flush();
+        events += output.getFrameStats().events;
+    }
+    uint64_t injected = SDL_GetTicksNS();
+    
+    uint64_t poll_time = gamepad_.getPollTimestampNs();
+    for (size_t slot = 0; slot < kMaxGamepads; ++slot) {
+        if (!gamepad_.isConnected(slot)) continue;
+        
+        uint64_t event_time = gamepad_.getInputTimestampNs(slot);
+        if (event_time == 0 || poll_time < event_time) continue;
+        
+        event_to_poll_latency_.record(poll_time - event_time);
+        dispatch_latency_.record(dispatched - poll_time);
+        if (events > 0) {
+            injection_latency_.record(injected - dispatched);
+            end_to_end_latency_.record(injected - event_time);
+        }
+    }
+}
+
+bool GamepadAPI::needsContinuousUpdate() const {
+    for (size_t slot = 0; slot < kMaxGamepads; ++slot) {
+        if (!gamepad_.isConnected(slot)) continue;
+        
+        float left_x, left_y, right_x, right_y;
+        stickResponse(GamepadStick::Left).apply(gamepad_.getAxis(slot, GamepadAxis::LeftX),
+                                                gamepad_.getAxis(slot, GamepadAxis::LeftY), left_x, left_y);
+        stickResponse(GamepadStick::Right).apply(gamepad_.getAxis(slot, GamepadAxis::RightX),
+                                                 gamepad_.getAxis(slot, GamepadAxis::RightY), right_x, right_y);
+        if (left_x != 0.0f || left_y != 0.0f || right_x != 0.0f || right_y != 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GamepadAPI::advanceTimers(uint64_t now_ns) {
+    // A repeat presses its binding again, which may start a macro that is
+    // due right away
+    auto_repeat_.advance(now_ns, [&](size_t slot, const ButtonBinding& binding) {
+        releaseBinding(pads_[slot], binding);
+        pressBinding(pads_[slot], binding, now_ns);
+    });
+    macro_player_.advance(now_ns);
+}
+
+int64_t GamepadAPI::nanosecondsUntilNextTimer() const {
+    uint64_t due = std::min(macro_player_.nextDeadlineNs(), auto_repeat_.nextDeadlineNs());
+    for (const auto& pad : pads_) {
+        if (pad.gestures.tracked() != 0) {
+            due = std::min(due, pad.gestures.nextDeadlineNs(config_->getGestures()));
+        }
+    }
+    if (due == MacroPlayer::kNoDeadline) return -1;
+    
+    uint64_t now = SDL_GetTicksNS();
+    return due > now ? static_cast<int64_t>(due - now) : 0;
+}
+
+float GamepadAPI::precisionAmount(const GamepadState& state) const {
+    switch (config_->getPointerAcceleration().precision_trigger) {
+        case PrecisionTrigger::Left:
+            return state.axis(GamepadAxis::LeftTrigger);
+        case PrecisionTrigger::Right:
+            return state.axis(GamepadAxis::RightTrigger);
+        case PrecisionTrigger::Off:
+            break;
+    }
+    return 0.0f;
+}
+
+ButtonMask GamepadAPI::precisionButton() const {
+    switch (config_->getPointerAcceleration().precision_trigger) {
+        case PrecisionTrigger::Left:
+            return buttonBit(GamepadButton::LeftTrigger);
+        case PrecisionTrigger::Right:
+            return buttonBit(GamepadButton::RightTrigger);
+        case PrecisionTrigger::Off:
+            break;
+    }
+    return 0;
+}
+
+void GamepadAPI::printLoopStats(std::chrono::steady_clock::duration elapsed) const {
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    std::cout << "Loop stats: " << wakeup_count_ << " wakeups in " << seconds << " s";
+    if (seconds > 0.0) {
+        std::cout << " (" << wakeup_count_ / seconds << "/s)";
+    }
+    std::cout << std::endl;
+    
+    // Frames are counted on the shared output, which every loop frame flushes
+    OutputStats output;
+    for (const auto& simulator : outputs_) {
+        OutputStats stats = simulator.getTotalStats();
+        output.events += stats.events;
+        output.flushes += stats.flushes;
+    }
+    uint64_t output_frames = outputs_[0].getFrameCount();
+    if (output_frames > 0) {
+        std::cout << "Output: " << output.events << " events in " << output.flushes
+                  << " flushes over " << output_frames << " frames ("
+                  << static_cast<double>(output.events) / output_frames << " events/frame)" << std::endl;
+    }
+    
+    printLatencyReport();
+}
+
+void GamepadAPI::printLatencyReport() const {
+    const LatencyHistogram& macro_lateness = macro_player_.getLateness();
+    if (end_to_end_latency_.count() == 0 && event_to_poll_latency_.count() == 0 && macro_lateness.count() == 0) {
+        std::cout << "Latency: no button events recorded" << std::endl;
+        return;
+    }
+    
+    std::cout << "Latency (us)        count      p50      p95      p99      max" << std::endl;
+    event_to_poll_latency_.printRow(std::cout, "event-to-poll");
+    dispatch_latency_.printRow(std::cout, "dispatch");
+    injection_latency_.printRow(std::cout, "injection");
+    end_to_end_latency_.printRow(std::cout, "end-to-end");
+    // How long after its due time each macro step was queued
+    if (macro_lateness.count() > 0) {
+        macro_lateness.printRow(std::cout, "macro-lateness");
+    }
+}
+
+void GamepadAPI::handleButtonAction(PadContext& pad, ButtonAction action) {
+    switch (action) {
+        case ButtonAction::Unmapped:
+        case ButtonAction::Macro:  // started by startMacro()
+        case ButtonAction::Count:
+            break;
+        case ButtonAction::LeftClick:
+            if (!pad.left_mouse_held) {
+                pad.output->leftMouseDown();
+                pad.left_mouse_held = true;
+                std::cout << "Left mouse down" << std::endl;
+            }
+            break;
+        case ButtonAction::RightClick:
+            if (!pad.right_mouse_held) {
+                pad.output->rightMouseDown();
+                pad.right_mouse_held = true;
+                std::cout << "Right mouse down" << std::endl;
+            }
+            break;
+        case ButtonAction::MiddleClick:
+            pad.output->middleClick();
+            std::cout << "Middle click" << std::endl;
+            break;
+        case ButtonAction::MediaPlayPause:
+            media_ctrl_.playPause();
+            std::cout << "Play/Pause" << std::endl;
+            break;
+        case ButtonAction::MediaNext:
+            media_ctrl_.next();
+            std::cout << "Next track" << std::endl;
+            break;
+        case ButtonAction::MediaPrevious:
+            media_ctrl_.previous();
+            std::cout << "Previous track" << std::endl;
+            break;
+        case ButtonAction::VoiceInput:
+            pad.output->sendShortcut(Shortcut::VoiceInput);
+            std::cout << "Voice input" << std::endl;
+            break;
+        case ButtonAction::AltTab:
+            pad.output->sendShortcut(Shortcut::AltTab);
+            std::cout << "Alt+Tab" << std::endl;
+            break;
+        case ButtonAction::WinTab:
+            pad.output->sendShortcut(Shortcut::WinTab);
+            std::cout << "Win+Tab" << std::endl;
+            break;
+        case ButtonAction::Escape:
+            pad.output->sendShortcut(Shortcut::Escape);
+            std::cout << "Escape" << std::endl;
+            break;
+        case ButtonAction::Enter:
+            pad.output->sendShortcut(Shortcut::Enter);
+            std::cout << "Enter" << std::endl;
+            break;
+        case ButtonAction::WindowsKey:
+            pad.output->sendShortcut(Shortcut::WinKey);
+            std::cout << "Windows key" << std::endl;
+            break;
+        case ButtonAction::Screenshot:
+            pad.output->sendShortcut(Shortcut::Screenshot);
+            std::cout << "Screenshot" << std::endl;
+            break;
+        case ButtonAction::VolumeUp:
+            media_ctrl_.volumeUp();
+            std::cout << "Volume up" << std::endl;
+            break;
+        case ButtonAction::VolumeDown:
+            media_ctrl_.volumeDown();
+            std::cout << "Volume down" << std::endl;
+            break;
+        case ButtonAction::VolumeMute:
+            media_ctrl_.volumeMute();
+            std::cout << "Volume mute" << std::endl;
+            break;
+        case ButtonAction::BrowserBack:
+            pad.output->sendShortcut(Shortcut::BrowserBack);
+            std::cout << "Browser back" << std::endl;
+            break;
+        case ButtonAction::BrowserForward:
+            pad.output->sendShortcut(Shortcut::BrowserForward);
+            std::cout << "Browser forward" << std::endl;
+            break;
+        case ButtonAction::IncreaseMouseSensitivity:
+            mouse_sensitivity_ = std::min(kMaxSensitivity, mouse_sensitivity_ + kSensitivityStep);
+            updateSettings([this](ConfigManager& config) { config.setMouseSensitivity(mouse_sensitivity_); });
+            std::cout << "Mouse sensitivity: " << mouse_sensitivity_ << std::endl;
+            break;
+        case ButtonAction::DecreaseMouseSensitivity:
+            mouse_sensitivity_ = std::max(kMinSensitivity, mouse_sensitivity_ - kSensitivityStep);
+            updateSettings([this](ConfigManager& config) { config.setMouseSensitivity(mouse_sensitivity_); });
+            std::cout << "Mouse sensitivity: " << mouse_sensitivity_ << std::endl;
+            break;
+        case ButtonAction::IncreaseScrollSensitivity:
+            scroll_sensitivity_ = std::min(kMaxSensitivity, scroll_sensitivity_ + kSensitivityStep);
+            updateSettings([this](ConfigManager& config) { config.setScrollSensitivity(scroll_sensitivity_); });
+            std::cout << "Scroll sensitivity: " << scroll_sensitivity_ << std::endl;
+            break;
+        case ButtonAction::DecreaseScrollSensitivity:
+            scroll_sensitivity_ = std::max(kMinSensitivity, scroll_sensitivity_ - kSensitivityStep);
+            updateSettings([this](ConfigManager& config) { config.setScrollSensitivity(scroll_sensitivity_); });
+            std::cout << "Scroll sensitivity: " << scroll_sensitivity_ << std::endl;
+            break;
+        case ButtonAction::Exit:
+            std::cout << "Exiting program..." << std::endl;
+            running_ = false;
+            break;
+    }
+}
+
+void GamepadAPI::handleButtonRelease(PadContext& pad, ButtonAction action) {
+    if (action == ButtonAction::LeftClick && pad.left_mouse_held) {
+        pad.output->leftMouseUp();
+        pad.left_mouse_held = false;
+        std::cout << "Left mouse up" << std::endl;
+    } else if (action == ButtonAction::RightClick && pad.right_mouse_held) {
+        pad.output->rightMouseUp();
+        pad.right_mouse_held = false;
+        std::cout << "Right mouse up" << std::endl;
+    }
+}
+
+void GamepadAPI::startMacro(PadContext& pad, uint8_t macro, uint64_t now_ns) {
+    // Steps play from the loop as they fall due, timed from this press
+    if (macro_player_.start(config_->getMacroEvents(macro), *pad.output, now_ns)) {
+        std::cout << "Macro " << config_->getMacroName(macro) << std::endl;
+    } else {
+        std::cout << "Macro " << config_->getMacroName(macro) << " not started (undefined or too many playing)"
+                  << std::endl;
+    }
+}
+
+void GamepadAPI::pressBinding(PadContext& pad, const ButtonBinding& binding, uint64_t now_ns) {
+    if (binding.action == ButtonAction::Macro) {
+        startMacro(pad, binding.macro, now_ns);
+    } else {
+        handleButtonAction(pad, binding.action);
+    }
+}
+
+void GamepadAPI::releaseBinding(PadContext& pad, const ButtonBinding& binding) {
+    handleButtonRelease(pad, binding.action);
+}
+
+void GamepadAPI::updateLayer(size_t slot, ButtonMask buttons, ButtonMask pressed) {
+    PadContext& pad = pads_[slot];
+    ButtonMask modifiers = config_->getLayerModifiers();
+    size_t layer = 0;
+    if ((pressed & modifiers) != 0) {
+        layer = config_->getModifierLayer(static_cast<GamepadButton>(std::countr_zero(pressed & modifiers)));
+    } else if ((buttons & config_->getLayerModifier(pad.layer)) != 0) {
+        layer = pad.layer;
+    } else if ((buttons & modifiers) != 0) {
+        layer = config_->getModifierLayer(static_cast<GamepadButton>(std::countr_zero(buttons & modifiers)));
+    }
+    
+    if (layer != pad.layer) {
+        pad.layer = layer;
+        std::cout << "pad" << slot + 1 << " layer: " << config_->getLayerName(layer) << std::endl;
+    }
+}
+
+void GamepadAPI::processGamepadInput(size_t slot, const GamepadState& state, const SensorReadings& sensors) {
+    PadContext& pad = pads_[slot];
+    
+    // Time since the previous poll, capped so a stall cannot fling the
+    // cursor. Using poll timestamps rather than the wall clock keeps
+    // replays deterministic.
+    double frame_seconds = 0.0;
+    if (pad.last_poll_timestamp_ns != 0 && state.poll_timestamp_ns > pad.last_poll_timestamp_ns) {
+        frame_seconds = std::min(0.1, (state.poll_timestamp_ns - pad.last_poll_timestamp_ns) / 1e9);
+    }
+    pad.last_poll_timestamp_ns = state.poll_timestamp_ns;
+    
+    // Edges against the previous frame; only buttons that changed dispatch.
+    // The precision trigger only slows the pointer, its button never acts.
+    ButtonMask buttons = state.buttons & ~precisionButton();
+    ButtonMask changed = buttons ^ pad.prev_buttons;
+    ButtonMask pressed = changed & buttons;
+    ButtonMask released = changed & pad.prev_buttons;
+    pad.prev_buttons = buttons;
+    
+    // Gesture thresholds and repeats are timed from the SDL event time when
+    // the frame has one, so they don't depend on the poll rate
+    uint64_t edge_ns = state.input_timestamp_ns != 0 && state.input_timestamp_ns <= state.poll_timestamp_ns
+                           ? state.input_timestamp_ns : state.poll_timestamp_ns;
+    
+    // Modifier buttons only switch the layer; the other buttons look up
+    // their press in the layer's table
+    ButtonMask modifiers = config_->getLayerModifiers();
+    if ((changed & modifiers) != 0) {
+        updateLayer(slot, buttons, pressed);
+    }
+    const auto& bindings = config_->getButtonBindings(slot, pad.layer);
+    
+    // Buttons with a chord, long press or double tap go through the
+    // recognizer; the rest act on their edges, and release what they pressed
+    const GestureTable& gestures = config_->getGestures();
+    ButtonMask tracked = pad.gestures.tracked();
+    ButtonMask gesture_buttons = (gestures.deferred & ~modifiers) | tracked;
+    forEachButton(pressed & ~gesture_buttons & ~modifiers, [&](GamepadButton button) {
+        const ButtonBinding& binding = bindings[static_cast<size_t>(button)];
+        pad.held[static_cast<size_t>(button)] = binding;
+        pressBinding(pad, binding, state.poll_timestamp_ns);
+        auto_repeat_.start(slot, button, binding, config_->getRepeat(button), edge_ns);
+    });
+    forEachButton(released & ~tracked, [&](GamepadButton button) {
+        auto_repeat_.stop(slot, button);
+        releaseBinding(pad, pad.held[static_cast<size_t>(button)]);
+        pad.held[static_cast<size_t>(button)] = ButtonBinding{};
+    });
+    
+    if ((changed & gesture_buttons) != 0 || tracked != 0) {
+        pad.gestures.update(gestures, bindings, buttons, pressed & gesture_buttons & ~modifiers,
+                            released & tracked, edge_ns, state.poll_timestamp_ns);
+        for (const auto& event : pad.gestures.events()) {
+            if (event.down) {
+                pressBinding(pad, event.binding, state.poll_timestamp_ns);
+            } else {
+                releaseBinding(pad, event.binding);
+            }
+        }
+    }
+    
+    // Dead zones and response curves; (0, 0) means the stick is at rest
+    float left_x, left_y, right_x, right_y;
+    stickResponse(GamepadStick::Left).apply(state.axis(GamepadAxis::LeftX), state.axis(GamepadAxis::LeftY),
+                                            left_x, left_y);
+    stickResponse(GamepadStick::Right).apply(state.axis(GamepadAxis::RightX), state.axis(GamepadAxis::RightY),
+                                             right_x, right_y);
+    
+    // The layer decides which stick points and which scrolls; with both on
+    // one role, the left stick wins while it is deflected
+    float pointer_x = 0.0f, pointer_y = 0.0f, scroll_x = 0.0f, scroll_y = 0.0f;
+    auto route = [&](GamepadStick stick, float x, float y) {
+        StickRole role = config_->getStickRole(pad.layer, stick);
+        float& target_x = role == StickRole::Pointer ? pointer_x : scroll_x;
+        float& target_y = role == StickRole::Pointer ? pointer_y : scroll_y;
+        if (role != StickRole::Off && target_x == 0.0f && target_y == 0.0f) {
+            target_x = x;
+            target_y = y;
+        }
+    };
+    route(GamepadStick::Left, left_x, left_y);
+    route(GamepadStick::Right, right_x, right_y);
+    
+    // Mouse movement in pixels per second with sub-pixel carry
+    if (pointer_x != 0.0f || pointer_y != 0.0f) {
+        // The deflection began around this wakeup, so the first frame
+        // only arms the integrator instead of crediting the idle gap
+        double dt = pad.pointer_moving ? frame_seconds : 0.0;
+        pad.pointer_moving = true;
+        
+        int delta_x = 0;
+        int delta_y = 0;
+        pad.pointer_motion.integrate(pointer_x, pointer_y, precisionAmount(state), dt, delta_x, delta_y);
+        if (delta_x != 0 || delta_y != 0) {
+            pad.output->moveMouse(delta_x, delta_y);
+        }
+    } else if (pad.pointer_moving) {
+        pad.pointer_moving = false;
+        pad.pointer_motion.reset();
+    }
+    
+    // Gyro pointer: every reading since the last frame, each over its own
+    // sensor interval
+    if (!sensors.gyro.empty() && config_->getGyro().enabled) {
+        for (const GyroSample& sample : sensors.gyro) {
+            pad.gyro_motion.addSample(sample, sensors.accel);
+        }
+        int delta_x = 0;
+        int delta_y = 0;
+        pad.gyro_motion.takeMotion(delta_x, delta_y);
+        if (delta_x != 0 || delta_y != 0) {
+            pad.output->moveMouse(delta_x, delta_y);
+        }
+    }
+    
+    // Scroll wheel in hi-res units with fractional carry; the vertical
+    // direction follows invert_scroll
+    if (scroll_x != 0.0f || scroll_y != 0.0f) {
+        double dt = pad.scrolling ? frame_seconds : 0.0;
+        pad.scrolling = true;
+        
+        float vertical = invert_scroll_y_ ? -scroll_y : scroll_y;
+        int units_x = 0;
+        int units_y = 0;
+        pad.scroll_motion.integrate(scroll_x, vertical, dt, units_x, units_y);
+        pad.output->smoothScroll(units_x, units_y);
+    } else if (pad.scrolling) {
+        pad.scrolling = false;
+        pad.scroll_motion.reset();
+    }
+}
@@ -1,10 +1,54 @@
 #include "gamepad_controller.h"
+#include <algorithm>
 #include <iostream>
 
+namespace {
+
+constexpr SDL_GamepadAxis kAxes[kGamepadAxisCount] = {
+    SDL_GAMEPAD_AXIS_LEFTX,
+    SDL_GAMEPAD_AXIS_LEFTY,
+    SDL_GAMEPAD_AXIS_RIGHTX,
+    SDL_GAMEPAD_AXIS_RIGHTY,
+    SDL_GAMEPAD_AXIS_LEFT_TRIGGER,
+    SDL_GAMEPAD_AXIS_RIGHT_TRIGGER
+};
+
+// Same order as GamepadButton
+constexpr SDL_GamepadButton kButtons[kGamepadDigitalButtonCount] = {
+    SDL_GAMEPAD_BUTTON_SOUTH,
+    SDL_GAMEPAD_BUTTON_EAST,
+    SDL_GAMEPAD_BUTTON_WEST,
+    SDL_GAMEPAD_BUTTON_NORTH,
+    SDL_GAMEPAD_BUTTON_START,
+    SDL_GAMEPAD_BUTTON_BACK,
+    SDL_GAMEPAD_BUTTON_GUIDE,
+    SDL_GAMEPAD_BUTTON_LEFT_SHOULDER,
+    SDL_GAMEPAD_BUTTON_RIGHT_SHOULDER,
+    SDL_GAMEPAD_BUTTON_LEFT_STICK,
+    SDL_GAMEPAD_BUTTON_RIGHT_STICK,
+    SDL_GAMEPAD_BUTTON_DPAD_UP,
+    SDL_GAMEPAD_BUTTON_DPAD_DOWN,
+    SDL_GAMEPAD_BUTTON_DPAD_LEFT,
+    SDL_GAMEPAD_BUTTON_DPAD_RIGHT
+};
+
+constexpr SDL_SensorType kSensors[] = {SDL_SENSOR_GYRO, SDL_SENSOR_ACCEL};
+
+} // namespace
+
 GamepadController::GamepadController() 
-    : gamepad_(nullptr)
-    , current_state_{}
-    , previous_state_{}
+    : gamepads_{}
+    , gamepad_ids_{}
+    , axes_{}
+    , buttons_{}
+    , input_timestamps_ns_{}
+    , pending_input_timestamps_ns_{}
+    , poll_timestamp_ns_(0)
+    , gyro_samples_{}
+    , gyro_counts_{}
+    , gyro_timestamps_ns_{}
+    , accel_{}
+    , sensors_enabled_(false)
 {
 }
 
@@ -13,71 +57,190 @@ GamepadController::~GamepadController() {
 }
 
 bool GamepadController::initialize() {
-    if (SDL_Init(SDL_INIT_GAMEPAD) < 0) {
+    if (!SDL_Init(SDL_INIT_GAMEPAD)) {
         std::cerr << "SDL initialization failed: " << SDL_GetError() << std::endl;
         return false;
     }
     
-    // Wait for gamepad connection
-    std::cout << "Waiting for gamepad connection..." << std::endl;
-    
-    int timeout = 5000; // 5 second timeout
-    while (timeout > 0) {
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_EVENT_GAMEPAD_ADDED) {
-                gamepad_ = SDL_OpenGamepad(event.gdevice.which);
-                if (gamepad_) {
-                    std::cout << "Gamepad connected: " << SDL_GetGamepadName(gamepad_) << std::endl;
-                    return true;
-                }
-            }
-        }
-        
-        // 检查已连接的手柄
-        int num_joysticks = 0;
-        SDL_JoystickID* joysticks = SDL_GetJoysticks(&num_joysticks);
-        for (int i = 0; i < num_joysticks; ++i) {
-            if (SDL_IsGamepad(joysticks[i])) {
-                gamepad_ = SDL_OpenGamepad(joysticks[i]);
-                if (gamepad_) {
-                    std::cout << "Gamepad connected: " << SDL_GetGamepadName(gamepad_) << std::endl;
-                    SDL_free(joysticks);
-                    return true;
-                }
-            }
-        }
-        SDL_free(joysticks);
-        
-        SDL_Delay(100);
-        timeout -= 100;
-    }
-    
-    std::cout << "No gamepad detected within 5 seconds. Please ensure gamepad is connected and recognized by system." << std::endl;
-    return false;
+    // Pads that are already plugged in arrive as SDL_EVENT_GAMEPAD_ADDED
+    // just like later hotplugs, so there is nothing to wait for here
+    std::cout << "Gamepads are picked up as they connect" << std::endl;
+    return true;
 }
 
 void GamepadController::shutdown() {
-    if (gamepad_) {
-        SDL_CloseGamepad(gamepad_);
-        gamepad_ = nullptr;
+    for (size_t slot = 0; slot < kMaxGamepads; ++slot) {
+        closeSlot(slot);
     }
     SDL_Quit();
 }
 
 bool GamepadController::isConnected() const {
-    return gamepad_ != nullptr && SDL_GamepadConnected(gamepad_);
+    for (size_t slot = 0; slot < kMaxGamepads; ++slot) {
+        if (isConnected(slot)) return true;
+    }
+    return false;
+}
+
+bool GamepadController::isConnected(size_t slot) const {
+    return slot < kMaxGamepads && gamepads_[slot] != nullptr && SDL_GamepadConnected(gamepads_[slot]);
+}
+
+size_t GamepadController::getConnectedCount() const {
+    size_t count = 0;
+    for (size_t slot = 0; slot < kMaxGamepads; ++slot) {
+        count += isConnected(slot) ? 1 : 0;
+    }
+    return count;
 }
 
 GamepadState GamepadController::getState() const {
-    return current_state_;
+    for (size_t slot = 0; slot < kMaxGamepads; ++slot) {
+        if (gamepads_[slot]) return getState(slot);
+    }
+    return GamepadState{};
+}
+
+GamepadState GamepadController::getState(size_t slot) const {
+    GamepadState state;
+    for (size_t axis = 0; axis < kGamepadAxisCount; ++axis) {
+        state.axes[axis] = axes_[axis][slot];
+    }
+    state.buttons = buttons_[slot];
+    state.input_timestamp_ns = input_timestamps_ns_[slot];
+    state.poll_timestamp_ns = poll_timestamp_ns_;
+    return state;
+}
+
+SensorReadings GamepadController::getSensorReadings(size_t slot) const {
+    SensorReadings readings;
+    readings.gyro = std::span<const GyroSample>(gyro_samples_[slot].data(), gyro_counts_[slot]);
+    readings.accel = accel_[slot];
+    return readings;
+}
+
+float GamepadController::getAxis(size_t slot, GamepadAxis axis) const {
+    return axes_[static_cast<size_t>(axis)][slot];
+}
+
+uint64_t GamepadController::getInputTimestampNs(size_t slot) const {
+    return input_timestamps_ns_[slot];
+}
+
+uint64_t GamepadController::getPollTimestampNs() const {
+    return poll_timestamp_ns_;
 }
 
 void GamepadController::update() {
+    pending_input_timestamps_ns_.fill(0);
+    gyro_counts_.fill(0);
     processEvents();
     updateState();
 }
 
+void GamepadController::setSensorsEnabled(bool enabled) {
+    if (enabled == sensors_enabled_) return;
+    sensors_enabled_ = enabled;
+    for (size_t slot = 0; slot < kMaxGamepads; ++slot) {
+        if (gamepads_[slot]) applySensors(slot);
+    }
+}
+
+bool GamepadController::openGamepad(SDL_JoystickID id) {
+    if (findSlot(id) >= 0) return true;
+    
+    int slot = findSlot(0);
+    if (slot < 0) {
+        std::cout << "Ignoring gamepad: all " << kMaxGamepads << " slots in use" << std::endl;
+        return false;
+    }
+    
+    SDL_Gamepad* gamepad = SDL_OpenGamepad(id);
+    if (!gamepad) return false;
+    
+    gamepads_[slot] = gamepad;
+    gamepad_ids_[slot] = id;
+    std::cout << "手柄连接 (pad" << slot + 1 << "): " << SDL_GetGamepadName(gamepad) << std::endl;
+    if (sensors_enabled_) {
+        applySensors(static_cast<size_t>(slot));
+    }
+    return true;
+}
+
+void GamepadController::closeSlot(size_t slot) {
+    if (!gamepads_[slot]) return;
+    
+    SDL_CloseGamepad(gamepads_[slot]);
+    gamepads_[slot] = nullptr;
+    gamepad_ids_[slot] = 0;
+    
+    // A departed pad reads as released, so held buttons produce their release
+    for (auto& axis : axes_) axis[slot] = 0.0f;
+    buttons_[slot] = 0;
+    input_timestamps_ns_[slot] = 0;
+    gyro_counts_[slot] = 0;
+    gyro_timestamps_ns_[slot] = 0;
+    accel_[slot] = {};
+}
+
+void GamepadController::applySensors(size_t slot) {
+    SDL_Gamepad* gamepad = gamepads_[slot];
+    for (SDL_SensorType sensor : kSensors) {
+        if (SDL_GamepadHasSensor(gamepad, sensor)) {
+            SDL_SetGamepadSensorEnabled(gamepad, sensor, sensors_enabled_);
+        }
+    }
+    // The first reading after a switch only restarts the sensor clock
+    gyro_timestamps_ns_[slot] = 0;
+    
+    if (!sensors_enabled_) return;
+    if (SDL_GamepadHasSensor(gamepad, SDL_SENSOR_GYRO)) {
+        std::cout << "pad" << slot + 1 << ": gyro at " << SDL_GetGamepadSensorDataRate(gamepad, SDL_SENSOR_GYRO)
+                  << " Hz" << std::endl;
+    } else {
+        std::cout << "pad" << slot + 1 << ": no gyro" << std::endl;
+    }
+}
+
+void GamepadController::addSensorReading(size_t slot, const SDL_GamepadSensorEvent& event) {
+    if (event.sensor == SDL_SENSOR_ACCEL) {
+        accel_[slot] = {event.data[0], event.data[1], event.data[2]};
+        return;
+    }
+    if (event.sensor != SDL_SENSOR_GYRO) return;
+    
+    // Spacing comes from the sensor's own clock when the driver has one
+    uint64_t timestamp = event.sensor_timestamp != 0 ? event.sensor_timestamp : event.timestamp;
+    uint64_t previous = gyro_timestamps_ns_[slot];
+    gyro_timestamps_ns_[slot] = timestamp;
+    if (previous == 0 || timestamp <= previous) return;
+    
+    GyroSample sample;
+    sample.rate = {event.data[0], event.data[1], event.data[2]};
+    sample.dt_us = static_cast<uint32_t>(std::min<uint64_t>((timestamp - previous) / 1000, UINT32_MAX));
+    
+    uint8_t& count = gyro_counts_[slot];
+    if (count < kMaxGyroSamples) {
+        gyro_samples_[slot][count++] = sample;
+        return;
+    }
+    // Full (slow fixed-rate poll): average into the last reading by time
+    GyroSample& last = gyro_samples_[slot][kMaxGyroSamples - 1];
+    uint32_t total_us = last.dt_us + sample.dt_us;
+    if (total_us == 0) return;
+    for (size_t axis = 0; axis < 3; ++axis) {
+        last.rate[axis] = (last.rate[axis] * last.dt_us + sample.rate[axis] * sample.dt_us) / total_us;
+    }
+    last.dt_us = total_us;
+}
+
+int GamepadController::findSlot(SDL_JoystickID id) const {
+    for (size_t slot = 0; slot < kMaxGamepads; ++slot) {
+        if (gamepad_ids_[slot] == id) return static_cast<int>(slot);
+    }
+    return -1;
+}
+
 void GamepadController::setButtonCallback(std::function<void(int, bool)> callback) {
     button_callback_ = callback;
 }
@@ -86,78 +249,126 @@ void GamepadController::setAxisCallback(std::function<void(int, float)> callback
     axis_callback_ = callback;
 }
 
+void GamepadController::waitForEvents(int timeout_ms) {
+    pending_input_timestamps_ns_.fill(0);
+    gyro_counts_.fill(0);
+    
+    SDL_Event event;
+    if (SDL_WaitEventTimeout(&event, timeout_ms)) {
+        handleEvent(event);
+    }
+    processEvents();
+    updateState();
+}
+
+void GamepadController::setQuitCallback(std::function<void()> callback) {
+    quit_callback_ = callback;
+}
+
+void GamepadController::setUserEventCallback(std::function<void(const SDL_UserEvent&)> callback) {
+    user_event_callback_ = callback;
+}
+
+void GamepadController::setEventCallback(std::function<void(const SDL_Event&)> callback) {
+    event_callback_ = callback;
+}
+
 void GamepadController::processEvents() {
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
-        switch (event.type) {
-            case SDL_EVENT_GAMEPAD_ADDED:
-                if (!gamepad_) {
-                    gamepad_ = SDL_OpenGamepad(event.gdevice.which);
-                    if (gamepad_) {
-                        std::cout << "手柄连接: " << SDL_GetGamepadName(gamepad_) << std::endl;
-                    }
-                }
-                break;
-                
-            case SDL_EVENT_GAMEPAD_REMOVED:
-                if (gamepad_ && event.gdevice.which == SDL_GetGamepadID(gamepad_)) {
-                    SDL_CloseGamepad(gamepad_);
-                    gamepad_ = nullptr;
-                    std::cout << "Gamepad disconnected" << std::endl;
+        handleEvent(event);
+    }
+}
+
+void GamepadController::handleEvent(const SDL_Event& event) {
+    if (event_callback_ && event.type >= SDL_EVENT_GAMEPAD_AXIS_MOTION &&
+        event.type <= SDL_EVENT_GAMEPAD_REMOVED) {
+        event_callback_(event);
+    }
+    
+    switch (event.type) {
+        case SDL_EVENT_GAMEPAD_ADDED:
+            openGamepad(event.gdevice.which);
+            break;
+            
+        case SDL_EVENT_GAMEPAD_REMOVED: {
+            int slot = findSlot(event.gdevice.which);
+            if (slot >= 0) {
+                closeSlot(static_cast<size_t>(slot));
+                std::cout << "Gamepad disconnected (pad" << slot + 1 << ")" << std::endl;
+            }
+            break;
+        }
+            
+        case SDL_EVENT_GAMEPAD_BUTTON_DOWN:
+        case SDL_EVENT_GAMEPAD_BUTTON_UP: {
+            int slot = findSlot(event.gbutton.which);
+            if (slot >= 0) {
+                if (pending_input_timestamps_ns_[slot] == 0) {
+                    pending_input_timestamps_ns_[slot] = event.gbutton.timestamp;
                 }
-                break;
-                
-            case SDL_EVENT_GAMEPAD_BUTTON_DOWN:
-            case SDL_EVENT_GAMEPAD_BUTTON_UP:
-                if (button_callback_ && gamepad_ && 
-                    event.gbutton.which == SDL_GetGamepadID(gamepad_)) {
+                if (button_callback_) {
                     button_callback_(event.gbutton.button, 
                                    event.type == SDL_EVENT_GAMEPAD_BUTTON_DOWN);
                 }
-                break;
-                
-            case SDL_EVENT_GAMEPAD_AXIS_MOTION:
-                if (axis_callback_ && gamepad_ && 
-                    event.gaxis.which == SDL_GetGamepadID(gamepad_)) {
-                    float value = event.gaxis.value / 32767.0f;
-                    axis_callback_(event.gaxis.axis, value);
-                }
-                break;
+            }
+            break;
         }
+            
+        case SDL_EVENT_GAMEPAD_SENSOR_UPDATE: {
+            int slot = findSlot(event.gsensor.which);
+            if (slot >= 0) {
+                addSensorReading(static_cast<size_t>(slot), event.gsensor);
+            }
+            break;
+        }
+            
+        case SDL_EVENT_GAMEPAD_AXIS_MOTION:
+            if (axis_callback_ && findSlot(event.gaxis.which) >= 0) {
+                float value = event.gaxis.value / 32767.0f;
+                axis_callback_(event.gaxis.axis, value);
+            }
+            break;
+            
+        case SDL_EVENT_QUIT:
+            if (quit_callback_) {
+                quit_callback_();
+            }
+            break;
+            
+        default:
+            if (event.type >= SDL_EVENT_USER && user_event_callback_) {
+                user_event_callback_(event.user);
+            }
+            break;
     }
 }
 
 void GamepadController::updateState() {
     if (!isConnected()) return;
     
-    previous_state_ = current_state_;
-    
-    // 读取摇杆
-    current_state_.left_stick_x = SDL_GetGamepadAxis(gamepad_, SDL_GAMEPAD_AXIS_LEFTX) / 32767.0f;
-    current_state_.left_stick_y = SDL_GetGamepadAxis(gamepad_, SDL_GAMEPAD_AXIS_LEFTY) / 32767.0f;
-    current_state_.right_stick_x = SDL_GetGamepadAxis(gamepad_, SDL_GAMEPAD_AXIS_RIGHTX) / 32767.0f;
-    current_state_.right_stick_y = SDL_GetGamepadAxis(gamepad_, SDL_GAMEPAD_AXIS_RIGHTY) / 32767.0f;
+    input_timestamps_ns_ = pending_input_timestamps_ns_;
+    poll_timestamp_ns_ = SDL_GetTicksNS();
     
-    // 读取扳机
-    current_state_.left_trigger = SDL_GetGamepadAxis(gamepad_, SDL_GAMEPAD_AXIS_LEFT_TRIGGER) / 32767.0f;
-    current_state_.right_trigger = SDL_GetGamepadAxis(gamepad_, SDL_GAMEPAD_AXIS_RIGHT_TRIGGER) / 32767.0f;
-    
-    // 读取按钮
-    current_state_.button_a = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_SOUTH);
-    current_state_.button_b = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_EAST);
-    current_state_.button_x = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_WEST);
-    current_state_.button_y = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_NORTH);
-    current_state_.button_start = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_START);
-    current_state_.button_back = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_BACK);
-    current_state_.button_guide = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_GUIDE);
-    current_state_.left_shoulder = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_LEFT_SHOULDER);
-    current_state_.right_shoulder = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_RIGHT_SHOULDER);
-    current_state_.left_stick_button = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_LEFT_STICK);
-    current_state_.right_stick_button = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_RIGHT_STICK);
+    // 读取摇杆和扳机 (empty slots read as centred)
+    for (size_t axis = 0; axis < kGamepadAxisCount; ++axis) {
+        for (size_t slot = 0; slot < kMaxGamepads; ++slot) {
+            axes_[axis][slot] = gamepads_[slot] ? SDL_GetGamepadAxis(gamepads_[slot], kAxes[axis]) / 32767.0f : 0.0f;
+        }
+    }
     
-    // 读取方向键
-    current_state_.dpad_up = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_DPAD_UP);
-    current_state_.dpad_down = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_DPAD_DOWN);
-    current_state_.dpad_left = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_DPAD_LEFT);
-    current_state_.dpad_right = SDL_GetGamepadButton(gamepad_, SDL_GAMEPAD_BUTTON_DPAD_RIGHT);
+    // 读取按钮; triggers pressed past the threshold count as buttons
+    const auto& left_trigger = axes_[static_cast<size_t>(GamepadAxis::LeftTrigger)];
+    const auto& right_trigger = axes_[static_cast<size_t>(GamepadAxis::RightTrigger)];
+    for (size_t slot = 0; slot < kMaxGamepads; ++slot) {
+        ButtonMask mask = 0;
+        if (gamepads_[slot]) {
+            for (size_t button = 0; button < kGamepadDigitalButtonCount; ++button) {
+                mask |= static_cast<ButtonMask>(SDL_GetGamepadButton(gamepads_[slot], kButtons[button])) << button;
+            }
+        }
+        if (left_trigger[slot] > kTriggerPressThreshold) mask |= buttonBit(GamepadButton::LeftTrigger);
+        if (right_trigger[slot] > kTriggerPressThreshold) mask |= buttonBit(GamepadButton::RightTrigger);
+        buttons_[slot] = mask;
+    }
 }
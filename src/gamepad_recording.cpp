@@ -0,0 +1,511 @@
+#include "gamepad_recording.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char kMagic[4] = {'G', 'P', 'R', 'C'};
+constexpr uint16_t kFormatVersion = 4;
+// Same layout without sensor records
+constexpr uint16_t kOldestFormatVersion = 3;
+constexpr size_t kHeaderSize = 16;
+constexpr int kAxisCount = static_cast<int>(kGamepadAxisCount);
+constexpr int kButtonCount = static_cast<int>(kGamepadButtonCount);
+
+// Low nibble of the tag is the RecordKind, high nibble the gamepad slot
+constexpr uint8_t kTagKindMask = 0x0f;
+constexpr int kTagPadShift = 4;
+
+constexpr uint8_t kMaskButtons = 1 << 0;
+constexpr uint8_t kMaskAxis0 = 1 << 1;
+constexpr uint8_t kMaskInputTimestamp = 1 << 7;
+
+// Largest record: tag, time delta, mask, buttons, six axes, input age
+constexpr size_t kMaxRecordSize = 1 + 10 + 1 + 10 + kAxisCount * 2 + 10;
+// Tag, time delta, count, readings (interval and three rates), accelerometer
+constexpr size_t kMaxSensorRecordSize = 1 + 10 + 1 + kMaxGyroSamples * (5 + 3 * 4) + 3 * 4;
+
+// Back to the raw value SDL reported; GamepadController divides by 32767
+int16_t quantizeAxis(float value) {
+    long raw = std::lround(value * 32767.0f);
+    if (raw < -32768) raw = -32768;
+    if (raw > 32767) raw = 32767;
+    return static_cast<int16_t>(raw);
+}
+
+size_t putVarint(uint8_t* out, uint64_t value) {
+    size_t size = 0;
+    while (value >= 0x80) {
+        out[size++] = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    out[size++] = static_cast<uint8_t>(value);
+    return size;
+}
+
+size_t putInt16(uint8_t* out, int16_t value) {
+    uint16_t bits = static_cast<uint16_t>(value);
+    out[0] = static_cast<uint8_t>(bits);
+    out[1] = static_cast<uint8_t>(bits >> 8);
+    return 2;
+}
+
+size_t putFloat(uint8_t* out, float value) {
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (size_t byte = 0; byte < 4; ++byte) {
+        out[byte] = static_cast<uint8_t>(bits >> (8 * byte));
+    }
+    return 4;
+}
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+} // namespace
+
+GamepadRecorder::GamepadRecorder()
+    : last_states_{}
+    , last_timestamp_ns_(0)
+    , frame_count_(0)
+    , bytes_written_(0)
+    , has_frame_{}
+{
+}
+
+GamepadRecorder::~GamepadRecorder() {
+    close();
+}
+
+bool GamepadRecorder::open(const std::string& path) {
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_.is_open()) {
+        std::cerr << "Cannot create recording: " << path << std::endl;
+        return false;
+    }
+    
+    uint8_t header[kHeaderSize] = {};
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    header[4] = static_cast<uint8_t>(kFormatVersion);
+    header[5] = static_cast<uint8_t>(kFormatVersion >> 8);
+    header[6] = kAxisCount;
+    header[7] = kButtonCount;
+    writeRecord(header, sizeof(header));
+    
+    last_states_.fill(GamepadState{});
+    last_timestamp_ns_ = 0;
+    frame_count_ = 0;
+    has_frame_.fill(false);
+    std::cout << "Recording gamepad input to " << path << std::endl;
+    return true;
+}
+
+void GamepadRecorder::close() {
+    if (file_.is_open()) {
+        file_.close();
+    }
+}
+
+bool GamepadRecorder::isOpen() const {
+    return file_.is_open();
+}
+
+void GamepadRecorder::recordFrame(const GamepadState& state, size_t pad, const SensorReadings& sensors) {
+    if (!file_.is_open() || pad >= kMaxGamepads) return;
+    
+    // Gyro readings go first so the frame that follows carries them
+    if (!sensors.gyro.empty()) {
+        uint8_t sensor[kMaxSensorRecordSize];
+        size_t size = 0;
+        sensor[size++] = static_cast<uint8_t>(RecordKind::Sensor) | static_cast<uint8_t>(pad << kTagPadShift);
+        size += putVarint(sensor + size, zigzag(static_cast<int64_t>(state.poll_timestamp_ns - last_timestamp_ns_)));
+        last_timestamp_ns_ = state.poll_timestamp_ns;
+        size_t count = std::min(sensors.gyro.size(), kMaxGyroSamples);
+        sensor[size++] = static_cast<uint8_t>(count);
+        for (size_t index = 0; index < count; ++index) {
+            const GyroSample& sample = sensors.gyro[index];
+            size += putVarint(sensor + size, sample.dt_us);
+            for (float rate : sample.rate) size += putFloat(sensor + size, rate);
+        }
+        for (float value : sensors.accel) size += putFloat(sensor + size, value);
+        writeRecord(sensor, size);
+    }
+    
+    // Deltas are against the same pad's previous frame
+    const GamepadState& last_state = last_states_[pad];
+    bool has_frame = has_frame_[pad];
+    
+    uint8_t record[kMaxRecordSize];
+    size_t size = 0;
+    record[size++] = static_cast<uint8_t>(RecordKind::Frame) | static_cast<uint8_t>(pad << kTagPadShift);
+    size += putVarint(record + size, zigzag(static_cast<int64_t>(state.poll_timestamp_ns - last_timestamp_ns_)));
+    last_timestamp_ns_ = state.poll_timestamp_ns;
+    
+    size_t mask_offset = size++;
+    uint8_t mask = 0;
+    
+    if (!has_frame || state.buttons != last_state.buttons) {
+        mask |= kMaskButtons;
+        size += putVarint(record + size, state.buttons);
+    }
+    for (int axis = 0; axis < kAxisCount; ++axis) {
+        int16_t value = quantizeAxis(state.axes[axis]);
+        if (!has_frame || value != quantizeAxis(last_state.axes[axis])) {
+            mask |= kMaskAxis0 << axis;
+            size += putInt16(record + size, value);
+        }
+    }
+    if (state.input_timestamp_ns != 0 && state.input_timestamp_ns <= state.poll_timestamp_ns) {
+        mask |= kMaskInputTimestamp;
+        size += putVarint(record + size, state.poll_timestamp_ns - state.input_timestamp_ns);
+    }
+    record[mask_offset] = mask;
+    
+    writeRecord(record, size);
+    last_states_[pad] = state;
+    has_frame_[pad] = true;
+    ++frame_count_;
+}
+
+void GamepadRecorder::recordEvent(const SDL_Event& event) {
+    if (!file_.is_open()) return;
+    
+    RecordedEventKind kind;
+    uint8_t index = 0;
+    int16_t value = 0;
+    uint32_t device = 0;
+    switch (event.type) {
+        case SDL_EVENT_GAMEPAD_BUTTON_DOWN:
+        case SDL_EVENT_GAMEPAD_BUTTON_UP:
+            kind = event.type == SDL_EVENT_GAMEPAD_BUTTON_DOWN ? RecordedEventKind::ButtonDown
+                                                              : RecordedEventKind::ButtonUp;
+            index = event.gbutton.button;
+            device = event.gbutton.which;
+            break;
+        case SDL_EVENT_GAMEPAD_AXIS_MOTION:
+            kind = RecordedEventKind::AxisMotion;
+            index = event.gaxis.axis;
+            value = event.gaxis.value;
+            device = event.gaxis.which;
+            break;
+        case SDL_EVENT_GAMEPAD_ADDED:
+        case SDL_EVENT_GAMEPAD_REMOVED:
+            kind = event.type == SDL_EVENT_GAMEPAD_ADDED ? RecordedEventKind::Added
+                                                        : RecordedEventKind::Removed;
+            device = event.gdevice.which;
+            break;
+        default:
+            return;
+    }
+    
+    uint8_t record[kMaxRecordSize];
+    size_t size = 0;
+    record[size++] = static_cast<uint8_t>(RecordKind::Event);
+    size += putVarint(record + size, zigzag(static_cast<int64_t>(event.common.timestamp - last_timestamp_ns_)));
+    last_timestamp_ns_ = event.common.timestamp;
+    record[size++] = static_cast<uint8_t>(kind);
+    record[size++] = index;
+    size += putInt16(record + size, value);
+    size += putVarint(record + size, device);
+    writeRecord(record, size);
+}
+
+uint64_t GamepadRecorder::frameCount() const {
+    return frame_count_;
+}
+
+uint64_t GamepadRecorder::bytesWritten() const {
+    return bytes_written_;
+}
+
+void GamepadRecorder::writeRecord(const uint8_t* data, size_t size) {
+    file_.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    bytes_written_ += size;
+}
+
+GamepadReplay::GamepadReplay()
+    : data_(nullptr)
+    , size_(0)
+    , offset_(0)
+    , states_{}
+    , gyro_samples_{}
+    , gyro_counts_{}
+    , accel_{}
+    , has_sensor_{}
+    , pad_(0)
+    , timestamp_ns_(0)
+    , event_count_(0)
+    , corrupt_(false)
+#ifdef _WIN32
+    , file_handle_(INVALID_HANDLE_VALUE)
+    , mapping_handle_(nullptr)
+#endif
+{
+}
+
+GamepadReplay::~GamepadReplay() {
+    close();
+}
+
+bool GamepadReplay::open(const std::string& path) {
+    close();
+
+#ifdef _WIN32
+    file_handle_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                               OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_handle_ == INVALID_HANDLE_VALUE) {
+        std::cerr << "Cannot open recording: " << path << std::endl;
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file_handle_, &file_size);
+    size_ = static_cast<size_t>(file_size.QuadPart);
+    if (size_ >= kHeaderSize) {
+        mapping_handle_ = CreateFileMappingA(file_handle_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_handle_) {
+            data_ = static_cast<const uint8_t*>(MapViewOfFile(mapping_handle_, FILE_MAP_READ, 0, 0, 0));
+        }
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Cannot open recording: " << path << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0) {
+        size_ = static_cast<size_t>(info.st_size);
+    }
+    if (size_ >= kHeaderSize) {
+        void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            data_ = static_cast<const uint8_t*>(mapping);
+            // Replay reads front to back exactly once
+            madvise(mapping, size_, MADV_SEQUENTIAL);
+        }
+    }
+    ::close(fd);
+#endif
+
+    if (!data_ || std::memcmp(data_, kMagic, sizeof(kMagic)) != 0 ||
+        (data_[4] | data_[5] << 8) < kOldestFormatVersion || (data_[4] | data_[5] << 8) > kFormatVersion ||
+        data_[6] != kAxisCount || data_[7] != kButtonCount) {
+        std::cerr << "Not a gamepad recording (or unsupported version): " << path << std::endl;
+        close();
+        return false;
+    }
+    
+    offset_ = kHeaderSize;
+    states_.fill(GamepadState{});
+    gyro_counts_.fill(0);
+    accel_.fill({});
+    has_sensor_.fill(false);
+    pad_ = 0;
+    timestamp_ns_ = 0;
+    event_count_ = 0;
+    corrupt_ = false;
+    return true;
+}
+
+void GamepadReplay::close() {
+#ifdef _WIN32
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_handle_) CloseHandle(mapping_handle_);
+    if (file_handle_ != INVALID_HANDLE_VALUE) CloseHandle(file_handle_);
+    mapping_handle_ = nullptr;
+    file_handle_ = INVALID_HANDLE_VALUE;
+#else
+    if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+#endif
+    data_ = nullptr;
+    size_ = 0;
+    offset_ = 0;
+}
+
+bool GamepadReplay::next(RecordKind& kind, RecordedEvent& event) {
+    if (!data_ || offset_ >= size_) return false;
+    
+    uint8_t tag = data_[offset_++];
+    uint8_t tag_kind = tag & kTagKindMask;
+    size_t pad = tag >> kTagPadShift;
+    uint64_t delta = 0;
+    if (tag_kind > static_cast<uint8_t>(RecordKind::Sensor) || pad >= kMaxGamepads ||
+        !readVarint(delta)) {
+        corrupt_ = true;
+        return false;
+    }
+    timestamp_ns_ += static_cast<uint64_t>(unzigzag(delta));
+    kind = static_cast<RecordKind>(tag_kind);
+    
+    if (kind == RecordKind::Event) {
+        uint64_t device = 0;
+        if (size_ - offset_ < 2) {
+            corrupt_ = true;
+            return false;
+        }
+        event.kind = static_cast<RecordedEventKind>(data_[offset_]);
+        event.index = data_[offset_ + 1];
+        offset_ += 2;
+        if (!readInt16(event.value) || !readVarint(device)) {
+            corrupt_ = true;
+            return false;
+        }
+        event.device = static_cast<uint32_t>(device);
+        event.timestamp_ns = timestamp_ns_;
+        ++event_count_;
+        return true;
+    }
+    
+    if (kind == RecordKind::Sensor) {
+        if (!readSensor(pad)) {
+            corrupt_ = true;
+            return false;
+        }
+        has_sensor_[pad] = true;
+        return true;
+    }
+    
+    if (offset_ >= size_) {
+        corrupt_ = true;
+        return false;
+    }
+    pad_ = pad;
+    GamepadState& state = states_[pad];
+    uint8_t mask = data_[offset_++];
+    if (mask & kMaskButtons) {
+        uint64_t buttons = 0;
+        if (!readVarint(buttons)) {
+            corrupt_ = true;
+            return false;
+        }
+        state.buttons = static_cast<ButtonMask>(buttons);
+    }
+    for (int axis = 0; axis < kAxisCount; ++axis) {
+        if (mask & (kMaskAxis0 << axis)) {
+            int16_t raw = 0;
+            if (!readInt16(raw)) {
+                corrupt_ = true;
+                return false;
+            }
+            state.axes[axis] = raw / 32767.0f;
+        }
+    }
+    state.input_timestamp_ns = 0;
+    if (mask & kMaskInputTimestamp) {
+        uint64_t age = 0;
+        if (!readVarint(age)) {
+            corrupt_ = true;
+            return false;
+        }
+        state.input_timestamp_ns = timestamp_ns_ - age;
+    }
+    state.poll_timestamp_ns = timestamp_ns_;
+    
+    // Readings belong to one frame only
+    if (!has_sensor_[pad]) {
+        gyro_counts_[pad] = 0;
+    }
+    has_sensor_[pad] = false;
+    return true;
+}
+
+bool GamepadReplay::nextFrame(GamepadState& state, size_t& pad) {
+    RecordKind kind;
+    RecordedEvent event;
+    while (next(kind, event)) {
+        if (kind == RecordKind::Frame) {
+            state = states_[pad_];
+            pad = pad_;
+            return true;
+        }
+    }
+    return false;
+}
+
+const GamepadState& GamepadReplay::state() const {
+    return states_[pad_];
+}
+
+SensorReadings GamepadReplay::sensorReadings() const {
+    SensorReadings readings;
+    readings.gyro = std::span<const GyroSample>(gyro_samples_[pad_].data(), gyro_counts_[pad_]);
+    readings.accel = accel_[pad_];
+    return readings;
+}
+
+size_t GamepadReplay::pad() const {
+    return pad_;
+}
+
+uint64_t GamepadReplay::eventCount() const {
+    return event_count_;
+}
+
+bool GamepadReplay::isCorrupt() const {
+    return corrupt_;
+}
+
+bool GamepadReplay::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && offset_ < size_; shift += 7) {
+        uint8_t byte = data_[offset_++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool GamepadReplay::readFloat(float& value) {
+    if (size_ - offset_ < 4) return false;
+    uint32_t bits = 0;
+    for (size_t byte = 0; byte < 4; ++byte) {
+        bits |= static_cast<uint32_t>(data_[offset_ + byte]) << (8 * byte);
+    }
+    std::memcpy(&value, &bits, sizeof(value));
+    offset_ += 4;
+    return true;
+}
+
+bool GamepadReplay::readSensor(size_t pad) {
+    if (offset_ >= size_) return false;
+    size_t count = data_[offset_++];
+    if (count > kMaxGyroSamples) return false;
+    
+    for (size_t index = 0; index < count; ++index) {
+        GyroSample& sample = gyro_samples_[pad][index];
+        uint64_t dt_us = 0;
+        if (!readVarint(dt_us)) return false;
+        sample.dt_us = static_cast<uint32_t>(dt_us);
+        for (float& rate : sample.rate) {
+            if (!readFloat(rate)) return false;
+        }
+    }
+    for (float& value : accel_[pad]) {
+        if (!readFloat(value)) return false;
+    }
+    gyro_counts_[pad] = static_cast<uint8_t>(count);
+    return true;
+}
+
+bool GamepadReplay::readInt16(int16_t& value) {
+    if (size_ - offset_ < 2) return false;
+    value = static_cast<int16_t>(data_[offset_] | data_[offset_ + 1] << 8);
+    offset_ += 2;
+    return true;
+}
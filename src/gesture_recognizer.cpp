@@ -0,0 +1,184 @@
+#include "gesture_recognizer.h"
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+constexpr uint64_t kNsPerMs = 1000000;
+
+bool bound(const ButtonBinding& binding) {
+    return binding.action != ButtonAction::Unmapped;
+}
+
+} // namespace
+
+void GestureTable::compile() {
+    chords_by_button.fill(0);
+    deferred = 0;
+    for (size_t chord = 0; chord < chord_count; ++chord) {
+        forEachButton(chords[chord].buttons, [&](GamepadButton button) {
+            chords_by_button[static_cast<size_t>(button)] |= static_cast<uint16_t>(1u << chord);
+        });
+        deferred |= chords[chord].buttons;
+    }
+    for (size_t button = 0; button < kGamepadButtonCount; ++button) {
+        if (bound(hold[button]) || bound(double_tap[button])) {
+            deferred |= buttonBit(static_cast<GamepadButton>(button));
+        }
+    }
+}
+
+GestureRecognizer::GestureRecognizer()
+    : states_{}
+    , since_ns_{}
+    , active_{}
+    , chord_of_{}
+    , pressing_(0)
+    , waiting_(0)
+    , tracked_(0)
+    , events_{}
+    , event_count_(0)
+{
+}
+
+void GestureRecognizer::update(const GestureTable& table,
+                               const std::array<ButtonBinding, kGamepadButtonCount>& bindings,
+                               ButtonMask buttons, ButtonMask pressed, ButtonMask released,
+                               uint64_t edge_ns, uint64_t now_ns) {
+    event_count_ = 0;
+    expire(table, bindings, edge_ns);
+    forEachButton(pressed, [&](GamepadButton button) {
+        press(table, buttons, static_cast<size_t>(button), edge_ns);
+    });
+    forEachButton(released, [&](GamepadButton button) {
+        release(table, bindings, static_cast<size_t>(button), edge_ns);
+    });
+    expire(table, bindings, now_ns);
+}
+
+std::span<const GestureEvent> GestureRecognizer::events() const {
+    return std::span<const GestureEvent>(events_.data(), event_count_);
+}
+
+uint64_t GestureRecognizer::nextDeadlineNs(const GestureTable& table) const {
+    uint64_t deadline = kNoDeadline;
+    forEachButton(pressing_ | waiting_, [&](GamepadButton button) {
+        deadline = std::min(deadline, deadlineFor(table, static_cast<size_t>(button)));
+    });
+    return deadline;
+}
+
+void GestureRecognizer::emit(const ButtonBinding& binding, bool down) {
+    if (bound(binding) && event_count_ < events_.size()) {
+        events_[event_count_++] = {binding, down};
+    }
+}
+
+void GestureRecognizer::set(size_t button, State state, uint64_t since_ns) {
+    ButtonMask bit = buttonBit(static_cast<GamepadButton>(button));
+    states_[button] = state;
+    since_ns_[button] = since_ns;
+    pressing_ = state == State::Pressed ? pressing_ | bit : pressing_ & ~bit;
+    waiting_ = state == State::WaitingSecondTap ? waiting_ | bit : waiting_ & ~bit;
+    tracked_ = state != State::Idle ? tracked_ | bit : tracked_ & ~bit;
+}
+
+uint64_t GestureRecognizer::deadlineFor(const GestureTable& table, size_t button) const {
+    if (states_[button] == State::WaitingSecondTap) {
+        return since_ns_[button] + table.double_tap_ms * kNsPerMs;
+    }
+    // A button with a long press or double tap decides at the hold time;
+    // a plain chord member only waits for the rest of the chord
+    bool waits_for_hold = bound(table.hold[button]) || bound(table.double_tap[button]);
+    return since_ns_[button] + (waits_for_hold ? table.hold_ms : table.chord_window_ms) * kNsPerMs;
+}
+
+void GestureRecognizer::expire(const GestureTable& table,
+                               const std::array<ButtonBinding, kGamepadButtonCount>& bindings,
+                               uint64_t now_ns) {
+    forEachButton(pressing_ | waiting_, [&](GamepadButton which) {
+        size_t button = static_cast<size_t>(which);
+        if (deadlineFor(table, button) > now_ns) return;
+        
+        if (states_[button] == State::Pressed) {
+            // Held long enough: the long press, or the button's own action
+            active_[button] = bound(table.hold[button]) ? table.hold[button] : bindings[button];
+            emit(active_[button], true);
+            set(button, State::Active, now_ns);
+        } else {
+            // No second tap came: it was a single tap
+            emit(bindings[button], true);
+            emit(bindings[button], false);
+            set(button, State::Idle, now_ns);
+        }
+    });
+}
+
+void GestureRecognizer::press(const GestureTable& table, ButtonMask buttons, size_t button, uint64_t edge_ns) {
+    if (states_[button] == State::WaitingSecondTap) {
+        active_[button] = table.double_tap[button];
+        emit(active_[button], true);
+        set(button, State::Active, edge_ns);
+        return;
+    }
+    
+    // The largest chord through this button whose other buttons are all
+    // down and still undecided
+    ButtonMask bit = buttonBit(static_cast<GamepadButton>(button));
+    const ChordBinding* best = nullptr;
+    for (uint16_t candidates = table.chords_by_button[button]; candidates != 0; candidates &= candidates - 1) {
+        const ChordBinding& chord = table.chords[std::countr_zero(candidates)];
+        bool complete = (buttons & chord.buttons) == chord.buttons && (chord.buttons & ~bit & ~pressing_) == 0;
+        if (complete && (!best || std::popcount(chord.buttons) > std::popcount(best->buttons))) {
+            best = &chord;
+        }
+    }
+    
+    if (best) {
+        emit(best->binding, true);
+        forEachButton(best->buttons, [&](GamepadButton member) {
+            size_t index = static_cast<size_t>(member);
+            active_[index] = best->binding;
+            chord_of_[index] = best->buttons;
+            set(index, State::InChord, edge_ns);
+        });
+        return;
+    }
+    set(button, State::Pressed, edge_ns);
+}
+
+void GestureRecognizer::release(const GestureTable& table,
+                                const std::array<ButtonBinding, kGamepadButtonCount>& bindings,
+                                size_t button, uint64_t edge_ns) {
+    switch (states_[button]) {
+        case State::Pressed:
+            // A tap; with a double tap bound it waits to see if another follows
+            if (bound(table.double_tap[button])) {
+                set(button, State::WaitingSecondTap, edge_ns);
+                return;
+            }
+            emit(bindings[button], true);
+            emit(bindings[button], false);
+            break;
+        case State::Active:
+            emit(active_[button], false);
+            break;
+        case State::InChord:
+            // The first member let go ends the chord; the rest just need
+            // releasing
+            emit(active_[button], false);
+            forEachButton(chord_of_[button], [&](GamepadButton member) {
+                size_t index = static_cast<size_t>(member);
+                if (states_[index] == State::InChord) set(index, State::ChordReleased, edge_ns);
+            });
+            break;
+        case State::ChordReleased:
+        case State::WaitingSecondTap:
+            break;
+        case State::Idle:
+            // Pressed before the config made it a gesture button
+            emit(bindings[button], false);
+            break;
+    }
+    set(button, State::Idle, edge_ns);
+}
@@ -0,0 +1,125 @@
+#include "gyro_motion.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kDegreesPerRadian = 57.29577951308232;
+// A reading after a longer gap (pad just enabled, stalled loop) only
+// counts for this long
+constexpr double kMaxSampleSeconds = 0.05;
+// Rest detection: every rate within kRestRateBand (rad/s, ~1.7 deg/s) and
+// every gravity component within kRestAccelBand (m/s^2) of its running
+// average for kRestSeconds
+constexpr double kAverageSeconds = 0.2;
+constexpr float kRestRateBand = 0.03f;
+constexpr float kRestAccelBand = 0.3f;
+constexpr double kRestSeconds = 0.5;
+// Zero-rate offsets beyond this (rad/s, ~5.7 deg/s) are a steady turn, not
+// bias
+constexpr float kMaxBias = 0.1f;
+// Once calibrated, the bias follows the resting rate this slowly
+constexpr double kBiasFollowSeconds = 1.0;
+constexpr double kSmoothingSeconds = 0.04;
+
+} // namespace
+
+GyroMotion::GyroMotion()
+    : bias_{}
+    , calibrated_(false)
+    , mean_rate_{}
+    , mean_accel_{}
+    , averaging_(false)
+    , rest_seconds_(0.0)
+    , smoothed_x_(0.0)
+    , smoothed_y_(0.0)
+    , remainder_x_(0.0)
+    , remainder_y_(0.0)
+{
+}
+
+void GyroMotion::configure(const GyroSettings& settings) {
+    settings_ = settings;
+}
+
+void GyroMotion::addSample(const GyroSample& sample, const std::array<float, 3>& accel) {
+    double dt = std::min(sample.dt_us / 1e6, kMaxSampleSeconds);
+    if (dt <= 0.0) return;
+    calibrate(sample, accel, dt);
+    
+    // Screen motion in deg/s: turning the pad left (+yaw) and tilting its
+    // front up (+pitch) move the pointer left and up
+    double x = -(sample.rate[1] - bias_[1]) * kDegreesPerRadian;
+    double y = -(sample.rate[0] - bias_[0]) * kDegreesPerRadian;
+    
+    // Tiered smoothing: the share of the rate below the threshold goes
+    // through the filter, the rest is used as is
+    double direct = 1.0;
+    if (settings_.smoothing > 0.0f) {
+        double magnitude = std::sqrt(x * x + y * y);
+        direct = std::clamp((magnitude - settings_.smoothing) / settings_.smoothing, 0.0, 1.0);
+    }
+    double alpha = 1.0 - std::exp(-dt / kSmoothingSeconds);
+    smoothed_x_ += alpha * (x * (1.0 - direct) - smoothed_x_);
+    smoothed_y_ += alpha * (y * (1.0 - direct) - smoothed_y_);
+    
+    double step = settings_.sensitivity * dt;
+    remainder_x_ += (x * direct + smoothed_x_) * step;
+    remainder_y_ += (y * direct + smoothed_y_) * step;
+}
+
+void GyroMotion::takeMotion(int& delta_x, int& delta_y) {
+    // Truncate toward zero so the carried remainder keeps the sign of the motion
+    double whole_x = std::trunc(remainder_x_);
+    double whole_y = std::trunc(remainder_y_);
+    remainder_x_ -= whole_x;
+    remainder_y_ -= whole_y;
+    
+    delta_x = static_cast<int>(whole_x);
+    delta_y = static_cast<int>(whole_y);
+}
+
+void GyroMotion::reset() {
+    bias_ = {};
+    calibrated_ = false;
+    mean_rate_ = {};
+    mean_accel_ = {};
+    averaging_ = false;
+    rest_seconds_ = 0.0;
+    smoothed_x_ = 0.0;
+    smoothed_y_ = 0.0;
+    remainder_x_ = 0.0;
+    remainder_y_ = 0.0;
+}
+
+void GyroMotion::calibrate(const GyroSample& sample, const std::array<float, 3>& accel, double dt_seconds) {
+    if (!averaging_) {
+        mean_rate_ = sample.rate;
+        mean_accel_ = accel;
+        averaging_ = true;
+    }
+    
+    float alpha = static_cast<float>(1.0 - std::exp(-dt_seconds / kAverageSeconds));
+    bool steady = true;
+    for (size_t axis = 0; axis < 3; ++axis) {
+        float rate_offset = sample.rate[axis] - mean_rate_[axis];
+        float accel_offset = accel[axis] - mean_accel_[axis];
+        steady = steady && std::fabs(rate_offset) < kRestRateBand && std::fabs(accel_offset) < kRestAccelBand;
+        mean_rate_[axis] += alpha * rate_offset;
+        mean_accel_[axis] += alpha * accel_offset;
+        steady = steady && std::fabs(mean_rate_[axis]) < kMaxBias;
+    }
+    rest_seconds_ = steady ? rest_seconds_ + dt_seconds : 0.0;
+    if (rest_seconds_ < kRestSeconds) return;
+    
+    // The first rest takes the average outright; later ones track drift
+    if (!calibrated_) {
+        bias_ = mean_rate_;
+        calibrated_ = true;
+        return;
+    }
+    float follow = static_cast<float>(1.0 - std::exp(-dt_seconds / kBiasFollowSeconds));
+    for (size_t axis = 0; axis < 3; ++axis) {
+        bias_[axis] += follow * (mean_rate_[axis] - bias_[axis]);
+    }
+}
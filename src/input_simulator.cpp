@@ -3,12 +3,60 @@
 
 #ifdef __linux__
 #include <unistd.h>
+#include <cstdlib>
 #include <cstring>
 #endif
 
+namespace {
+
+// Indexed by Shortcut
+constexpr KeyChord kShortcutChords[kShortcutCount] = {
+#ifdef _WIN32
+    {{VK_LWIN, 'H'}, 2},                 // VoiceInput: Win+H
+    {{VK_MENU, VK_TAB}, 2},              // AltTab
+    {{VK_LWIN, VK_TAB}, 2},              // WinTab: Task View
+    {{VK_ESCAPE}, 1},                    // Escape
+    {{VK_RETURN}, 1},                    // Enter
+    {{VK_LWIN}, 1},                      // WinKey
+    {{VK_LWIN, VK_LSHIFT, 'S'}, 3},      // Screenshot: Win+Shift+S
+    {{VK_MENU, VK_LEFT}, 2},             // BrowserBack: Alt+Left
+    {{VK_MENU, VK_RIGHT}, 2},            // BrowserForward: Alt+Right
+#elif __linux__
+    {{}, 0},                             // VoiceInput: no common binding
+    {{XK_Alt_L, XK_Tab}, 2},             // AltTab
+    {{XK_Super_L, XK_Tab}, 2},           // WinTab: Super+Tab on most desktops
+    {{XK_Escape}, 1},                    // Escape
+    {{XK_Return}, 1},                    // Enter
+    {{XK_Super_L}, 1},                   // WinKey
+    {{XK_Print}, 1},                     // Screenshot: Print Screen
+    {{XK_Alt_L, XK_Left}, 2},            // BrowserBack
+    {{XK_Alt_L, XK_Right}, 2},           // BrowserForward
+#elif __APPLE__
+    {{}, 0},                             // VoiceInput: no common binding
+    {{kVK_Command, kVK_Tab}, 2},         // AltTab: Cmd+Tab
+    {{kVK_Control, kVK_UpArrow}, 2},     // WinTab: Mission Control
+    {{kVK_Escape}, 1},                   // Escape
+    {{kVK_Return}, 1},                   // Enter
+    {{kVK_Command}, 1},                  // WinKey: Cmd
+    {{kVK_Command, kVK_Shift, kVK_ANSI_4}, 3},  // Screenshot: Cmd+Shift+4
+    {{kVK_Command, kVK_LeftArrow}, 2},   // BrowserBack
+    {{kVK_Command, kVK_RightArrow}, 2},  // BrowserForward
+#else
+    {}, {}, {}, {}, {}, {}, {}, {}, {},
+#endif
+};
+
+} // namespace
+
 InputSimulator::InputSimulator() 
+    : frame_count_(0)
+    , backend_(OutputBackend::Auto)
+    , active_backend_(OutputBackend::Auto)
+    , device_name_("Gamepad Desktop Bridge")
 #ifdef __linux__
-    : display_(nullptr)
+    , display_(nullptr)
+    , keycode_cache_{}
+    , keycode_cache_size_(0)
 #endif
 {
 }
@@ -17,10 +65,61 @@ InputSimulator::~InputSimulator() {
     shutdown();
 }
 
+void InputSimulator::setBackend(OutputBackend backend) {
+    backend_ = backend;
+}
+
+OutputBackend InputSimulator::getActiveBackend() const {
+    return active_backend_;
+}
+
+void InputSimulator::setDeviceName(const std::string& name) {
+    device_name_ = name;
+}
+
 bool InputSimulator::initialize() {
+    if (backend_ == OutputBackend::Null) {
+        active_backend_ = OutputBackend::Null;
+        return true;
+    }
+    
 #ifdef _WIN32
     return true;
 #elif __linux__
+    if (backend_ == OutputBackend::X11) {
+        return openX11();
+    }
+    if (backend_ == OutputBackend::Uinput) {
+        return openUinput();
+    }
+    
+    // Auto: XTest can't reach native Wayland clients, so prefer uinput there
+    if (getenv("WAYLAND_DISPLAY")) {
+        return openUinput() || openX11();
+    }
+    return openX11() || openUinput();
+#elif __APPLE__
+    return true;
+#else
+    return false;
+#endif
+}
+
+void InputSimulator::shutdown() {
+    // Don't leave anything that was queued this frame (e.g. a button release) unsent
+    flush();
+    
+#ifdef __linux__
+    if (display_) {
+        XCloseDisplay(display_);
+        display_ = nullptr;
+    }
+    uinput_.close();
+#endif
+}
+
+#ifdef __linux__
+bool InputSimulator::openX11() {
     display_ = XOpenDisplay(nullptr);
     if (!display_) {
         std::cerr << "Cannot open X11 display" << std::endl;
@@ -35,166 +134,123 @@ bool InputSimulator::initialize() {
         return false;
     }
     
+    rebuildKeycodeCache();
+    active_backend_ = OutputBackend::X11;
+    std::cout << "Output backend: XTest" << std::endl;
     return true;
-#elif __APPLE__
+}
+
+bool InputSimulator::openUinput() {
+    if (!uinput_.open(device_name_.c_str())) {
+        return false;
+    }
+    
+    active_backend_ = OutputBackend::Uinput;
+    std::cout << "Output backend: uinput" << std::endl;
     return true;
-#else
-    return false;
+}
 #endif
+
+void InputSimulator::flush() {
+    if (!pending_.empty()) {
+        submitPending();
+    }
+    
+    if (frame_stats_.events > 0) {
+        ++frame_count_;
+        total_stats_.events += frame_stats_.events;
+        total_stats_.flushes += frame_stats_.flushes;
+    }
+    last_frame_stats_ = frame_stats_;
+    frame_stats_ = OutputStats{};
 }
 
-void InputSimulator::shutdown() {
-#ifdef __linux__
-    if (display_) {
-        XCloseDisplay(display_);
-        display_ = nullptr;
+OutputStats InputSimulator::getFrameStats() const {
+    return last_frame_stats_;
+}
+
+OutputStats InputSimulator::getTotalStats() const {
+    return total_stats_;
+}
+
+uint64_t InputSimulator::getFrameCount() const {
+    return frame_count_;
+}
+
+void InputSimulator::setOutputObserver(std::function<void(const OutputBuffer&)> observer) {
+    output_observer_ = observer;
+}
+
+void InputSimulator::queue(const OutputCommand& command) {
+    if (!pending_.push(command)) {
+        // Buffer full mid-frame: submit what we have and keep going
+        submitPending();
+        pending_.push(command);
     }
-#endif
+}
+
+void InputSimulator::queueKey(int key_code, bool key_down) {
+    queue({OutputCommandType::Key, MouseButton::Left, key_down, key_code, 0});
+}
+
+void InputSimulator::queueMouseButton(MouseButton button, bool button_down) {
+    queue({OutputCommandType::MouseButton, button, button_down, 0, 0});
 }
 
 void InputSimulator::moveMouse(int delta_x, int delta_y) {
-#ifdef _WIN32
-    POINT cursor;
-    GetCursorPos(&cursor);
-    SetCursorPos(cursor.x + delta_x, cursor.y + delta_y);
-#elif __linux__
-    if (display_) {
-        XTestFakeRelativeMotionEvent(display_, delta_x, delta_y, CurrentTime);
-        XFlush(display_);
-    }
-#elif __APPLE__
-    CGPoint cursor = CGEventGetLocation(CGEventCreate(NULL));
-    CGWarpMouseCursorPosition(CGPointMake(cursor.x + delta_x, cursor.y + delta_y));
-#endif
+    queue({OutputCommandType::MouseMove, MouseButton::Left, false, delta_x, delta_y});
 }
 
 void InputSimulator::setMousePosition(int x, int y) {
-#ifdef _WIN32
-    SetCursorPos(x, y);
-#elif __linux__
-    if (display_) {
-        XTestFakeMotionEvent(display_, DefaultScreen(display_), x, y, CurrentTime);
-        XFlush(display_);
-    }
-#elif __APPLE__
-    CGWarpMouseCursorPosition(CGPointMake(x, y));
-#endif
+    queue({OutputCommandType::MouseWarp, MouseButton::Left, false, x, y});
 }
 
 void InputSimulator::leftClick() {
-#ifdef _WIN32
-    mouse_event(MOUSEEVENTF_LEFTDOWN, 0, 0, 0, 0);
-    mouse_event(MOUSEEVENTF_LEFTUP, 0, 0, 0, 0);
-#elif __linux__
-    simulateMouseClick(Button1, true);
-    simulateMouseClick(Button1, false);
-#elif __APPLE__
-    simulateMouseClick(kCGMouseButtonLeft, true);
-    simulateMouseClick(kCGMouseButtonLeft, false);
-#endif
+    queueMouseButton(MouseButton::Left, true);
+    queueMouseButton(MouseButton::Left, false);
 }
 
 void InputSimulator::leftMouseDown() {
-#ifdef _WIN32
-    mouse_event(MOUSEEVENTF_LEFTDOWN, 0, 0, 0, 0);
-#elif __linux__
-    simulateMouseClick(Button1, true);
-#elif __APPLE__
-    simulateMouseClick(kCGMouseButtonLeft, true);
-#endif
+    queueMouseButton(MouseButton::Left, true);
 }
 
 void InputSimulator::leftMouseUp() {
-#ifdef _WIN32
-    mouse_event(MOUSEEVENTF_LEFTUP, 0, 0, 0, 0);
-#elif __linux__
-    simulateMouseClick(Button1, false);
-#elif __APPLE__
-    simulateMouseClick(kCGMouseButtonLeft, false);
-#endif
+    queueMouseButton(MouseButton::Left, false);
 }
 
 void InputSimulator::rightClick() {
-#ifdef _WIN32
-    mouse_event(MOUSEEVENTF_RIGHTDOWN, 0, 0, 0, 0);
-    mouse_event(MOUSEEVENTF_RIGHTUP, 0, 0, 0, 0);
-#elif __linux__
-    simulateMouseClick(Button3, true);
-    simulateMouseClick(Button3, false);
-#elif __APPLE__
-    simulateMouseClick(kCGMouseButtonRight, true);
-    simulateMouseClick(kCGMouseButtonRight, false);
-#endif
+    queueMouseButton(MouseButton::Right, true);
+    queueMouseButton(MouseButton::Right, false);
 }
 
 void InputSimulator::rightMouseDown() {
-#ifdef _WIN32
-    mouse_event(MOUSEEVENTF_RIGHTDOWN, 0, 0, 0, 0);
-#elif __linux__
-    simulateMouseClick(Button3, true);
-#elif __APPLE__
-    simulateMouseClick(kCGMouseButtonRight, true);
-#endif
+    queueMouseButton(MouseButton::Right, true);
 }
 
 void InputSimulator::rightMouseUp() {
-#ifdef _WIN32
-    mouse_event(MOUSEEVENTF_RIGHTUP, 0, 0, 0, 0);
-#elif __linux__
-    simulateMouseClick(Button3, false);
-#elif __APPLE__
-    simulateMouseClick(kCGMouseButtonRight, false);
-#endif
+    queueMouseButton(MouseButton::Right, false);
 }
 
 void InputSimulator::middleClick() {
-#ifdef _WIN32
-    mouse_event(MOUSEEVENTF_MIDDLEDOWN, 0, 0, 0, 0);
-    mouse_event(MOUSEEVENTF_MIDDLEUP, 0, 0, 0, 0);
-#elif __linux__
-    simulateMouseClick(Button2, true);
-    simulateMouseClick(Button2, false);
-#elif __APPLE__
-    simulateMouseClick(kCGMouseButtonCenter, true);
-    simulateMouseClick(kCGMouseButtonCenter, false);
-#endif
+    queueMouseButton(MouseButton::Middle, true);
+    queueMouseButton(MouseButton::Middle, false);
 }
 
-void InputSimulator::scroll(int delta) {
-#ifdef _WIN32
-    mouse_event(MOUSEEVENTF_WHEEL, 0, 0, delta * WHEEL_DELTA, 0);
-#elif __linux__
-    if (display_) {
-        int button = (delta > 0) ? Button4 : Button5;
-        XTestFakeButtonEvent(display_, button, True, CurrentTime);
-        XTestFakeButtonEvent(display_, button, False, CurrentTime);
-        XFlush(display_);
-    }
-#elif __APPLE__
-    CGEventRef scroll_event = CGEventCreateScrollWheelEvent(NULL, kCGScrollEventUnitPixel, 1, delta * 10);
-    CGEventPost(kCGHIDEventTap, scroll_event);
-    CFRelease(scroll_event);
-#endif
+void InputSimulator::scroll(int notches) {
+    smoothScroll(0, notches * kWheelUnitsPerNotch);
+}
+
+void InputSimulator::smoothScroll(int units_x, int units_y) {
+    if (units_x == 0 && units_y == 0) return;
+    queue({OutputCommandType::Scroll, MouseButton::Left, false, units_x, units_y});
 }
 
 void InputSimulator::pressKey(int key_code) {
-#ifdef _WIN32
-    simulateKeyPress(key_code, true);
-#elif __linux__
-    simulateKeyPress(key_code, true);
-#elif __APPLE__
-    simulateKeyPress(key_code, true);
-#endif
+    queueKey(key_code, true);
 }
 
 void InputSimulator::releaseKey(int key_code) {
-#ifdef _WIN32
-    simulateKeyPress(key_code, false);
-#elif __linux__
-    simulateKeyPress(key_code, false);
-#elif __APPLE__
-    simulateKeyPress(key_code, false);
-#endif
+    queueKey(key_code, false);
 }
 
 void InputSimulator::typeKey(int key_code) {
@@ -231,367 +287,249 @@ void InputSimulator::typeText(const char* text) {
 #endif
 }
 
-void InputSimulator::triggerVoiceInput() {
-#ifdef _WIN32
-    // Win + H
-    keybd_event(VK_LWIN, 0, 0, 0);
-    keybd_event('H', 0, 0, 0);
-    keybd_event('H', 0, KEYEVENTF_KEYUP, 0);
-    keybd_event(VK_LWIN, 0, KEYEVENTF_KEYUP, 0);
-#elif __linux__
-    // Linux implementation would depend on the desktop environment
-    std::cout << "Voice input triggered (Linux not implemented yet)" << std::endl;
-#elif __APPLE__
-    // macOS voice input trigger
-    std::cout << "Voice input triggered (macOS not implemented yet)" << std::endl;
-#endif
-}
-
-void InputSimulator::altTab() {
-#ifdef _WIN32
-    // Alt + Tab
-    keybd_event(VK_MENU, 0, 0, 0);  // Alt down
-    keybd_event(VK_TAB, 0, 0, 0);   // Tab down
-    keybd_event(VK_TAB, 0, KEYEVENTF_KEYUP, 0);  // Tab up
-    keybd_event(VK_MENU, 0, KEYEVENTF_KEYUP, 0); // Alt up
-#elif __linux__
-    if (display_) {
-        KeyCode alt = XKeysymToKeycode(display_, XK_Alt_L);
-        KeyCode tab = XKeysymToKeycode(display_, XK_Tab);
-        
-        XTestFakeKeyEvent(display_, alt, True, CurrentTime);
-        XTestFakeKeyEvent(display_, tab, True, CurrentTime);
-        XTestFakeKeyEvent(display_, tab, False, CurrentTime);
-        XTestFakeKeyEvent(display_, alt, False, CurrentTime);
-        XFlush(display_);
+void InputSimulator::sendChord(const KeyChord& chord) {
+    for (uint8_t i = 0; i < chord.count; ++i) {
+        queueKey(chord.keys[i], true);
     }
-#elif __APPLE__
-    // macOS Cmd+Tab
-    CGEventRef cmd_down = CGEventCreateKeyboardEvent(NULL, kVK_Command, true);
-    CGEventRef tab_down = CGEventCreateKeyboardEvent(NULL, kVK_Tab, true);
-    CGEventRef tab_up = CGEventCreateKeyboardEvent(NULL, kVK_Tab, false);
-    CGEventRef cmd_up = CGEventCreateKeyboardEvent(NULL, kVK_Command, false);
-    
-    CGEventPost(kCGHIDEventTap, cmd_down);
-    CGEventPost(kCGHIDEventTap, tab_down);
-    CGEventPost(kCGHIDEventTap, tab_up);
-    CGEventPost(kCGHIDEventTap, cmd_up);
-    
-    CFRelease(cmd_down);
-    CFRelease(tab_down);
-    CFRelease(tab_up);
-    CFRelease(cmd_up);
-#endif
-}
-
-void InputSimulator::winTab() {
-#ifdef _WIN32
-    // Win + Tab (Task View)
-    keybd_event(VK_LWIN, 0, 0, 0);  // Win down
-    keybd_event(VK_TAB, 0, 0, 0);   // Tab down
-    keybd_event(VK_TAB, 0, KEYEVENTF_KEYUP, 0);  // Tab up
-    keybd_event(VK_LWIN, 0, KEYEVENTF_KEYUP, 0); // Win up
-#elif __linux__
-    // Linux: Super+Tab or similar depending on desktop environment
-    if (display_) {
-        KeyCode super = XKeysymToKeycode(display_, XK_Super_L);
-        KeyCode tab = XKeysymToKeycode(display_, XK_Tab);
-        
-        XTestFakeKeyEvent(display_, super, True, CurrentTime);
-        XTestFakeKeyEvent(display_, tab, True, CurrentTime);
-        XTestFakeKeyEvent(display_, tab, False, CurrentTime);
-        XTestFakeKeyEvent(display_, super, False, CurrentTime);
-        XFlush(display_);
+    for (uint8_t i = chord.count; i > 0; --i) {
+        queueKey(chord.keys[i - 1], false);
     }
-#elif __APPLE__
-    // macOS Mission Control (Ctrl+Up)
-    CGEventRef ctrl_down = CGEventCreateKeyboardEvent(NULL, kVK_Control, true);
-    CGEventRef up_down = CGEventCreateKeyboardEvent(NULL, kVK_UpArrow, true);
-    CGEventRef up_up = CGEventCreateKeyboardEvent(NULL, kVK_UpArrow, false);
-    CGEventRef ctrl_up = CGEventCreateKeyboardEvent(NULL, kVK_Control, false);
-    
-    CGEventPost(kCGHIDEventTap, ctrl_down);
-    CGEventPost(kCGHIDEventTap, up_down);
-    CGEventPost(kCGHIDEventTap, up_up);
-    CGEventPost(kCGHIDEventTap, ctrl_up);
-    
-    CFRelease(ctrl_down);
-    CFRelease(up_down);
-    CFRelease(up_up);
-    CFRelease(ctrl_up);
-#endif
 }
 
-void InputSimulator::escape() {
-#ifdef _WIN32
-    keybd_event(VK_ESCAPE, 0, 0, 0);
-    keybd_event(VK_ESCAPE, 0, KEYEVENTF_KEYUP, 0);
-#elif __linux__
-    if (display_) {
-        KeyCode esc = XKeysymToKeycode(display_, XK_Escape);
-        XTestFakeKeyEvent(display_, esc, True, CurrentTime);
-        XTestFakeKeyEvent(display_, esc, False, CurrentTime);
-        XFlush(display_);
+void InputSimulator::sendShortcut(Shortcut shortcut) {
+    const KeyChord& chord = kShortcutChords[static_cast<size_t>(shortcut)];
+    if (chord.count == 0) {
+        // Linux/macOS voice input depends on the desktop environment
+        std::cout << "Shortcut not available on this platform" << std::endl;
+        return;
     }
-#elif __APPLE__
-    CGEventRef esc_down = CGEventCreateKeyboardEvent(NULL, kVK_Escape, true);
-    CGEventRef esc_up = CGEventCreateKeyboardEvent(NULL, kVK_Escape, false);
-    CGEventPost(kCGHIDEventTap, esc_down);
-    CGEventPost(kCGHIDEventTap, esc_up);
-    CFRelease(esc_down);
-    CFRelease(esc_up);
-#endif
+    sendChord(chord);
 }
 
-void InputSimulator::enter() {
-#ifdef _WIN32
-    keybd_event(VK_RETURN, 0, 0, 0);
-    keybd_event(VK_RETURN, 0, KEYEVENTF_KEYUP, 0);
-#elif __linux__
-    if (display_) {
-        KeyCode enter = XKeysymToKeycode(display_, XK_Return);
-        XTestFakeKeyEvent(display_, enter, True, CurrentTime);
-        XTestFakeKeyEvent(display_, enter, False, CurrentTime);
-        XFlush(display_);
-    }
-#elif __APPLE__
-    CGEventRef enter_down = CGEventCreateKeyboardEvent(NULL, kVK_Return, true);
-    CGEventRef enter_up = CGEventCreateKeyboardEvent(NULL, kVK_Return, false);
-    CGEventPost(kCGHIDEventTap, enter_down);
-    CGEventPost(kCGHIDEventTap, enter_up);
-    CFRelease(enter_down);
-    CFRelease(enter_up);
-#endif
+void InputSimulator::sendCommand(const OutputCommand& command) {
+    queue(command);
 }
 
-void InputSimulator::winKey() {
-#ifdef _WIN32
-    keybd_event(VK_LWIN, 0, 0, 0);
-    keybd_event(VK_LWIN, 0, KEYEVENTF_KEYUP, 0);
-#elif __linux__
-    if (display_) {
-        KeyCode super = XKeysymToKeycode(display_, XK_Super_L);
-        XTestFakeKeyEvent(display_, super, True, CurrentTime);
-        XTestFakeKeyEvent(display_, super, False, CurrentTime);
-        XFlush(display_);
+// Private helper methods
+void InputSimulator::submitPending() {
+    frame_stats_.events += static_cast<uint32_t>(pending_.size());
+    ++frame_stats_.flushes;
+    
+    if (output_observer_) {
+        output_observer_(pending_);
     }
-#elif __APPLE__
-    // macOS Cmd key
-    CGEventRef cmd_down = CGEventCreateKeyboardEvent(NULL, kVK_Command, true);
-    CGEventRef cmd_up = CGEventCreateKeyboardEvent(NULL, kVK_Command, false);
-    CGEventPost(kCGHIDEventTap, cmd_down);
-    CGEventPost(kCGHIDEventTap, cmd_up);
-    CFRelease(cmd_down);
-    CFRelease(cmd_up);
-#endif
-}
-
-void InputSimulator::screenshot() {
-#ifdef _WIN32
-    // Win + Shift + S
-    keybd_event(VK_LWIN, 0, 0, 0);
-    keybd_event(VK_LSHIFT, 0, 0, 0);
-    keybd_event('S', 0, 0, 0);
-    keybd_event('S', 0, KEYEVENTF_KEYUP, 0);
-    keybd_event(VK_LSHIFT, 0, KEYEVENTF_KEYUP, 0);
-    keybd_event(VK_LWIN, 0, KEYEVENTF_KEYUP, 0);
-#elif __linux__
-    // Linux: depends on desktop environment, common is Print Screen
-    if (display_) {
-        KeyCode print = XKeysymToKeycode(display_, XK_Print);
-        XTestFakeKeyEvent(display_, print, True, CurrentTime);
-        XTestFakeKeyEvent(display_, print, False, CurrentTime);
-        XFlush(display_);
+    if (active_backend_ == OutputBackend::Null) {
+        pending_.clear();
+        return;
     }
-#elif __APPLE__
-    // macOS Cmd+Shift+4 (area screenshot)
-    CGEventRef cmd_down = CGEventCreateKeyboardEvent(NULL, kVK_Command, true);
-    CGEventRef shift_down = CGEventCreateKeyboardEvent(NULL, kVK_Shift, true);
-    CGEventRef four_down = CGEventCreateKeyboardEvent(NULL, kVK_ANSI_4, true);
-    CGEventRef four_up = CGEventCreateKeyboardEvent(NULL, kVK_ANSI_4, false);
-    CGEventRef shift_up = CGEventCreateKeyboardEvent(NULL, kVK_Shift, false);
-    CGEventRef cmd_up = CGEventCreateKeyboardEvent(NULL, kVK_Command, false);
-    
-    CGEventPost(kCGHIDEventTap, cmd_down);
-    CGEventPost(kCGHIDEventTap, shift_down);
-    CGEventPost(kCGHIDEventTap, four_down);
-    CGEventPost(kCGHIDEventTap, four_up);
-    CGEventPost(kCGHIDEventTap, shift_up);
-    CGEventPost(kCGHIDEventTap, cmd_up);
     
-    CFRelease(cmd_down);
-    CFRelease(shift_down);
-    CFRelease(four_down);
-    CFRelease(four_up);
-    CFRelease(shift_up);
-    CFRelease(cmd_up);
-#endif
-}
-
-void InputSimulator::mediaPlayPause() {
 #ifdef _WIN32
-    keybd_event(VK_MEDIA_PLAY_PAUSE, 0, 0, 0);
-    keybd_event(VK_MEDIA_PLAY_PAUSE, 0, KEYEVENTF_KEYUP, 0);
-#elif __linux__
-    (void)system("playerctl play-pause");
-#elif __APPLE__
-    (void)system("osascript -e 'tell application \"Music\" to playpause'");
-#endif
-}
-
-void InputSimulator::mediaNext() {
-#ifdef _WIN32
-    keybd_event(VK_MEDIA_NEXT_TRACK, 0, 0, 0);
-    keybd_event(VK_MEDIA_NEXT_TRACK, 0, KEYEVENTF_KEYUP, 0);
-#elif __linux__
-    (void)system("playerctl next");
-#elif __APPLE__
-    (void)system("osascript -e 'tell application \"Music\" to next track'");
-#endif
-}
-
-void InputSimulator::mediaPrevious() {
-#ifdef _WIN32
-    keybd_event(VK_MEDIA_PREV_TRACK, 0, 0, 0);
-    keybd_event(VK_MEDIA_PREV_TRACK, 0, KEYEVENTF_KEYUP, 0);
-#elif __linux__
-    (void)system("playerctl previous");
-#elif __APPLE__
-    (void)system("osascript -e 'tell application \"Music\" to previous track'");
-#endif
-}
-
-void InputSimulator::volumeUp() {
-#ifdef _WIN32
-    keybd_event(VK_VOLUME_UP, 0, 0, 0);
-    keybd_event(VK_VOLUME_UP, 0, KEYEVENTF_KEYUP, 0);
-#elif __linux__
-    (void)system("pactl set-sink-volume @DEFAULT_SINK@ +5%");
-#elif __APPLE__
-    (void)system("osascript -e 'set volume output volume (output volume of (get volume settings) + 10)'");
-#endif
-}
-
-void InputSimulator::volumeDown() {
-#ifdef _WIN32
-    keybd_event(VK_VOLUME_DOWN, 0, 0, 0);
-    keybd_event(VK_VOLUME_DOWN, 0, KEYEVENTF_KEYUP, 0);
-#elif __linux__
-    (void)system("pactl set-sink-volume @DEFAULT_SINK@ -5%");
-#elif __APPLE__
-    (void)system("osascript -e 'set volume output volume (output volume of (get volume settings) - 10)'");
-#endif
-}
-
-void InputSimulator::volumeMute() {
-#ifdef _WIN32
-    keybd_event(VK_VOLUME_MUTE, 0, 0, 0);
-    keybd_event(VK_VOLUME_MUTE, 0, KEYEVENTF_KEYUP, 0);
-#elif __linux__
-    (void)system("pactl set-sink-mute @DEFAULT_SINK@ toggle");
-#elif __APPLE__
-    (void)system("osascript -e 'set volume with output muted'");
-#endif
-}
-
-void InputSimulator::browserBack() {
-#ifdef _WIN32
-    // Alt + Left Arrow
-    keybd_event(VK_MENU, 0, 0, 0);  // Alt down
-    keybd_event(VK_LEFT, 0, 0, 0);  // Left arrow down
-    keybd_event(VK_LEFT, 0, KEYEVENTF_KEYUP, 0);  // Left arrow up
-    keybd_event(VK_MENU, 0, KEYEVENTF_KEYUP, 0);  // Alt up
+    // Everything except cursor warps goes out in a single SendInput call.
+    // Moves keep using SetCursorPos so Windows pointer acceleration does not
+    // distort the already integrated deltas. A scroll with both axes takes
+    // two entries, every other command at most one.
+    INPUT inputs[2 * OutputBuffer::kCapacity];
+    UINT count = 0;
+    auto send_batch = [&]() {
+        if (count > 0) {
+            SendInput(count, inputs, sizeof(INPUT));
+            count = 0;
+        }
+    };
+    
+    for (const auto& command : pending_) {
+        switch (command.type) {
+            case OutputCommandType::MouseMove: {
+                send_batch();
+                POINT cursor;
+                GetCursorPos(&cursor);
+                SetCursorPos(cursor.x + command.x, cursor.y + command.y);
+                break;
+            }
+            case OutputCommandType::MouseWarp:
+                send_batch();
+                SetCursorPos(command.x, command.y);
+                break;
+            case OutputCommandType::MouseButton: {
+                INPUT& input = inputs[count++];
+                ZeroMemory(&input, sizeof(INPUT));
+                input.type = INPUT_MOUSE;
+                if (command.button == MouseButton::Left) {
+                    input.mi.dwFlags = command.down ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_LEFTUP;
+                } else if (command.button == MouseButton::Right) {
+                    input.mi.dwFlags = command.down ? MOUSEEVENTF_RIGHTDOWN : MOUSEEVENTF_RIGHTUP;
+                } else {
+                    input.mi.dwFlags = command.down ? MOUSEEVENTF_MIDDLEDOWN : MOUSEEVENTF_MIDDLEUP;
+                }
+                break;
+            }
+            case OutputCommandType::Scroll:
+                // Windows takes fractions of WHEEL_DELTA directly
+                if (command.y != 0) {
+                    INPUT& input = inputs[count++];
+                    ZeroMemory(&input, sizeof(INPUT));
+                    input.type = INPUT_MOUSE;
+                    input.mi.dwFlags = MOUSEEVENTF_WHEEL;
+                    input.mi.mouseData = static_cast<DWORD>(command.y * WHEEL_DELTA / kWheelUnitsPerNotch);
+                }
+                if (command.x != 0) {
+                    INPUT& input = inputs[count++];
+                    ZeroMemory(&input, sizeof(INPUT));
+                    input.type = INPUT_MOUSE;
+                    input.mi.dwFlags = MOUSEEVENTF_HWHEEL;
+                    input.mi.mouseData = static_cast<DWORD>(command.x * WHEEL_DELTA / kWheelUnitsPerNotch);
+                }
+                break;
+            case OutputCommandType::Key: {
+                INPUT& input = inputs[count++];
+                ZeroMemory(&input, sizeof(INPUT));
+                input.type = INPUT_KEYBOARD;
+                input.ki.wVk = static_cast<WORD>(command.x);
+                input.ki.dwFlags = command.down ? 0 : KEYEVENTF_KEYUP;
+                break;
+            }
+        }
+    }
+    send_batch();
 #elif __linux__
-    if (display_) {
-        KeyCode alt = XKeysymToKeycode(display_, XK_Alt_L);
-        KeyCode left = XKeysymToKeycode(display_, XK_Left);
-        XTestFakeKeyEvent(display_, alt, True, CurrentTime);
-        XTestFakeKeyEvent(display_, left, True, CurrentTime);
-        XTestFakeKeyEvent(display_, left, False, CurrentTime);
-        XTestFakeKeyEvent(display_, alt, False, CurrentTime);
+    if (active_backend_ == OutputBackend::Uinput) {
+        // One write() and one SYN_REPORT for the whole frame
+        uinput_.submit(pending_);
+    } else if (display_) {
+        bool mapping_checked = false;
+        for (const auto& command : pending_) {
+            switch (command.type) {
+                case OutputCommandType::MouseMove:
+                    XTestFakeRelativeMotionEvent(display_, command.x, command.y, CurrentTime);
+                    break;
+                case OutputCommandType::MouseWarp:
+                    XTestFakeMotionEvent(display_, DefaultScreen(display_), command.x, command.y, CurrentTime);
+                    break;
+                case OutputCommandType::MouseButton:
+                    if (command.button == MouseButton::Left) {
+                        simulateMouseClick(Button1, command.down);
+                    } else if (command.button == MouseButton::Right) {
+                        simulateMouseClick(Button3, command.down);
+                    } else {
+                        simulateMouseClick(Button2, command.down);
+                    }
+                    break;
+                case OutputCommandType::Scroll:
+                    // XTest can only click the wheel buttons, so whole
+                    // notches go out as repeated clicks
+                    simulateWheelClicks(Button4, Button5, wheel_steps_y_.add(command.y, kWheelUnitsPerNotch));
+                    // Buttons 6 and 7 scroll left and right (Xlib has no names for them)
+                    simulateWheelClicks(7, 6, wheel_steps_x_.add(command.x, kWheelUnitsPerNotch));
+                    break;
+                case OutputCommandType::Key:
+                    // Only batches with keys pay for looking at X events
+                    if (!mapping_checked) {
+                        processXEvents();
+                        mapping_checked = true;
+                    }
+                    simulateKeyPress(keycodeFor(static_cast<KeySym>(command.x)), command.down);
+                    break;
+            }
+        }
+        // One round trip to the X server for the whole batch
         XFlush(display_);
     }
 #elif __APPLE__
-    // macOS Cmd + Left
-    CGEventRef cmd_down = CGEventCreateKeyboardEvent(NULL, kVK_Command, true);
-    CGEventRef left_down = CGEventCreateKeyboardEvent(NULL, kVK_LeftArrow, true);
-    CGEventRef left_up = CGEventCreateKeyboardEvent(NULL, kVK_LeftArrow, false);
-    CGEventRef cmd_up = CGEventCreateKeyboardEvent(NULL, kVK_Command, false);
-    
-    CGEventPost(kCGHIDEventTap, cmd_down);
-    CGEventPost(kCGHIDEventTap, left_down);
-    CGEventPost(kCGHIDEventTap, left_up);
-    CGEventPost(kCGHIDEventTap, cmd_up);
-    
-    CFRelease(cmd_down);
-    CFRelease(left_down);
-    CFRelease(left_up);
-    CFRelease(cmd_up);
+    for (const auto& command : pending_) {
+        switch (command.type) {
+            case OutputCommandType::MouseMove: {
+                CGEventRef location_event = CGEventCreate(NULL);
+                CGPoint cursor = CGEventGetLocation(location_event);
+                CFRelease(location_event);
+                CGWarpMouseCursorPosition(CGPointMake(cursor.x + command.x, cursor.y + command.y));
+                break;
+            }
+            case OutputCommandType::MouseWarp:
+                CGWarpMouseCursorPosition(CGPointMake(command.x, command.y));
+                break;
+            case OutputCommandType::MouseButton:
+                if (command.button == MouseButton::Left) {
+                    simulateMouseClick(kCGMouseButtonLeft, command.down);
+                } else if (command.button == MouseButton::Right) {
+                    simulateMouseClick(kCGMouseButtonRight, command.down);
+                } else {
+                    simulateMouseClick(kCGMouseButtonCenter, command.down);
+                }
+                break;
+            case OutputCommandType::Scroll: {
+                // 10 pixels per notch, as before
+                int pixels_y = wheel_steps_y_.add(command.y, kWheelUnitsPerNotch / 10);
+                int pixels_x = wheel_steps_x_.add(command.x, kWheelUnitsPerNotch / 10);
+                if (pixels_x == 0 && pixels_y == 0) break;
+                CGEventRef scroll_event = CGEventCreateScrollWheelEvent(NULL, kCGScrollEventUnitPixel, 2, pixels_y, pixels_x);
+                CGEventPost(kCGHIDEventTap, scroll_event);
+                CFRelease(scroll_event);
+                break;
+            }
+            case OutputCommandType::Key:
+                simulateKeyPress(static_cast<CGKeyCode>(command.x), command.down);
+                break;
+        }
+    }
 #endif
+    
+    pending_.clear();
 }
 
-void InputSimulator::browserForward() {
-#ifdef _WIN32
-    // Alt + Right Arrow
-    keybd_event(VK_MENU, 0, 0, 0);  // Alt down
-    keybd_event(VK_RIGHT, 0, 0, 0);  // Right arrow down
-    keybd_event(VK_RIGHT, 0, KEYEVENTF_KEYUP, 0);  // Right arrow up
-    keybd_event(VK_MENU, 0, KEYEVENTF_KEYUP, 0);  // Alt up
-#elif __linux__
-    if (display_) {
-        KeyCode alt = XKeysymToKeycode(display_, XK_Alt_L);
-        KeyCode right = XKeysymToKeycode(display_, XK_Right);
-        XTestFakeKeyEvent(display_, alt, True, CurrentTime);
-        XTestFakeKeyEvent(display_, right, True, CurrentTime);
-        XTestFakeKeyEvent(display_, right, False, CurrentTime);
-        XTestFakeKeyEvent(display_, alt, False, CurrentTime);
-        XFlush(display_);
+#ifdef __linux__
+void InputSimulator::rebuildKeycodeCache() {
+    keycode_cache_size_ = 0;
+    for (const auto& chord : kShortcutChords) {
+        for (uint8_t i = 0; i < chord.count; ++i) {
+            keycodeFor(static_cast<KeySym>(chord.keys[i]));
+        }
     }
-#elif __APPLE__
-    // macOS Cmd + Right
-    CGEventRef cmd_down = CGEventCreateKeyboardEvent(NULL, kVK_Command, true);
-    CGEventRef right_down = CGEventCreateKeyboardEvent(NULL, kVK_RightArrow, true);
-    CGEventRef right_up = CGEventCreateKeyboardEvent(NULL, kVK_RightArrow, false);
-    CGEventRef cmd_up = CGEventCreateKeyboardEvent(NULL, kVK_Command, false);
-    
-    CGEventPost(kCGHIDEventTap, cmd_down);
-    CGEventPost(kCGHIDEventTap, right_down);
-    CGEventPost(kCGHIDEventTap, right_up);
-    CGEventPost(kCGHIDEventTap, cmd_up);
-    
-    CFRelease(cmd_down);
-    CFRelease(right_down);
-    CFRelease(right_up);
-    CFRelease(cmd_up);
-#endif
 }
 
-// Private helper methods
-#ifdef _WIN32
-void InputSimulator::simulateKeyPress(WORD key, bool key_down) {
-    DWORD flags = key_down ? 0 : KEYEVENTF_KEYUP;
-    keybd_event(key, 0, flags, 0);
+KeyCode InputSimulator::keycodeFor(KeySym keysym) {
+    for (size_t i = 0; i < keycode_cache_size_; ++i) {
+        if (keycode_cache_[i].keysym == keysym) return keycode_cache_[i].keycode;
+    }
+    
+    // XKeysymToKeycode scans the whole keyboard mapping
+    KeyCode keycode = XKeysymToKeycode(display_, keysym);
+    if (keycode_cache_size_ < keycode_cache_.size()) {
+        keycode_cache_[keycode_cache_size_++] = {keysym, keycode};
+    }
+    return keycode;
+}
+
+void InputSimulator::processXEvents() {
+    // Nothing is selected on this connection, so the only events are ones
+    // every client gets, MappingNotify among them
+    bool mapping_changed = false;
+    while (XPending(display_) > 0) {
+        XEvent event;
+        XNextEvent(display_, &event);
+        if (event.type == MappingNotify) {
+            XRefreshKeyboardMapping(&event.xmapping);
+            mapping_changed = true;
+        }
+    }
+    if (mapping_changed) {
+        rebuildKeycodeCache();
+    }
 }
 
-void InputSimulator::simulateMouseClick(DWORD button, bool button_down) {
-    // Windows mouse_event uses separate flags for down and up
-    // MOUSEEVENTF_LEFTDOWN = 0x0002, MOUSEEVENTF_LEFTUP = 0x0004
-    // MOUSEEVENTF_RIGHTDOWN = 0x0008, MOUSEEVENTF_RIGHTUP = 0x0010
-    // MOUSEEVENTF_MIDDLEDOWN = 0x0020, MOUSEEVENTF_MIDDLEUP = 0x0040
-    mouse_event(button, 0, 0, 0, 0);
-}
-#elif __linux__
+// Callers flush once per batch, see submitPending()
 void InputSimulator::simulateKeyPress(KeyCode key, bool key_down) {
-    if (display_) {
-        XTestFakeKeyEvent(display_, key, key_down, CurrentTime);
-        XFlush(display_);
-    }
+    XTestFakeKeyEvent(display_, key, key_down, CurrentTime);
 }
 
 void InputSimulator::simulateMouseClick(int button, bool button_down) {
-    if (display_) {
-        XTestFakeButtonEvent(display_, button, button_down, CurrentTime);
-        XFlush(display_);
+    XTestFakeButtonEvent(display_, button, button_down, CurrentTime);
+}
+
+void InputSimulator::simulateWheelClicks(int up_button, int down_button, int steps) {
+    int button = steps > 0 ? up_button : down_button;
+    for (int i = std::abs(steps); i > 0; --i) {
+        simulateMouseClick(button, true);
+        simulateMouseClick(button, false);
     }
 }
 #elif __APPLE__
@@ -0,0 +1,98 @@
+#include "key_names.h"
+#include <cstddef>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif __linux__
+#include <X11/keysym.h>
+#elif __APPLE__
+#include <Carbon/Carbon.h>
+#endif
+
+namespace {
+
+struct KeyName {
+    std::string_view name;
+    int key_code;
+};
+
+// Keys with a name; single letters and digits are handled below
+constexpr KeyName kNamedKeys[] = {
+#ifdef _WIN32
+    {"ctrl", VK_CONTROL}, {"alt", VK_MENU}, {"shift", VK_SHIFT}, {"super", VK_LWIN},
+    {"tab", VK_TAB}, {"escape", VK_ESCAPE}, {"enter", VK_RETURN}, {"space", VK_SPACE},
+    {"backspace", VK_BACK}, {"delete", VK_DELETE}, {"insert", VK_INSERT},
+    {"home", VK_HOME}, {"end", VK_END}, {"page_up", VK_PRIOR}, {"page_down", VK_NEXT},
+    {"left", VK_LEFT}, {"right", VK_RIGHT}, {"up", VK_UP}, {"down", VK_DOWN},
+    {"print", VK_SNAPSHOT},
+    {"f1", VK_F1}, {"f2", VK_F2}, {"f3", VK_F3}, {"f4", VK_F4}, {"f5", VK_F5}, {"f6", VK_F6},
+    {"f7", VK_F7}, {"f8", VK_F8}, {"f9", VK_F9}, {"f10", VK_F10}, {"f11", VK_F11}, {"f12", VK_F12},
+#elif __linux__
+    {"ctrl", XK_Control_L}, {"alt", XK_Alt_L}, {"shift", XK_Shift_L}, {"super", XK_Super_L},
+    {"tab", XK_Tab}, {"escape", XK_Escape}, {"enter", XK_Return}, {"space", XK_space},
+    {"backspace", XK_BackSpace}, {"delete", XK_Delete}, {"insert", XK_Insert},
+    {"home", XK_Home}, {"end", XK_End}, {"page_up", XK_Page_Up}, {"page_down", XK_Page_Down},
+    {"left", XK_Left}, {"right", XK_Right}, {"up", XK_Up}, {"down", XK_Down},
+    {"print", XK_Print},
+    {"f1", XK_F1}, {"f2", XK_F2}, {"f3", XK_F3}, {"f4", XK_F4}, {"f5", XK_F5}, {"f6", XK_F6},
+    {"f7", XK_F7}, {"f8", XK_F8}, {"f9", XK_F9}, {"f10", XK_F10}, {"f11", XK_F11}, {"f12", XK_F12},
+#elif __APPLE__
+    // "super" is Command, like the WinKey shortcut; there is no Print Screen
+    {"ctrl", kVK_Control}, {"alt", kVK_Option}, {"shift", kVK_Shift}, {"super", kVK_Command},
+    {"tab", kVK_Tab}, {"escape", kVK_Escape}, {"enter", kVK_Return}, {"space", kVK_Space},
+    {"backspace", kVK_Delete}, {"delete", kVK_ForwardDelete}, {"insert", kVK_Help},
+    {"home", kVK_Home}, {"end", kVK_End}, {"page_up", kVK_PageUp}, {"page_down", kVK_PageDown},
+    {"left", kVK_LeftArrow}, {"right", kVK_RightArrow}, {"up", kVK_UpArrow}, {"down", kVK_DownArrow},
+    {"f1", kVK_F1}, {"f2", kVK_F2}, {"f3", kVK_F3}, {"f4", kVK_F4}, {"f5", kVK_F5}, {"f6", kVK_F6},
+    {"f7", kVK_F7}, {"f8", kVK_F8}, {"f9", kVK_F9}, {"f10", kVK_F10}, {"f11", kVK_F11}, {"f12", kVK_F12},
+#else
+    {"", 0},
+#endif
+};
+
+#ifdef __APPLE__
+// macOS key codes follow the ANSI keyboard layout, not the alphabet
+constexpr int kLetterKeys[26] = {
+    kVK_ANSI_A, kVK_ANSI_B, kVK_ANSI_C, kVK_ANSI_D, kVK_ANSI_E, kVK_ANSI_F, kVK_ANSI_G,
+    kVK_ANSI_H, kVK_ANSI_I, kVK_ANSI_J, kVK_ANSI_K, kVK_ANSI_L, kVK_ANSI_M, kVK_ANSI_N,
+    kVK_ANSI_O, kVK_ANSI_P, kVK_ANSI_Q, kVK_ANSI_R, kVK_ANSI_S, kVK_ANSI_T, kVK_ANSI_U,
+    kVK_ANSI_V, kVK_ANSI_W, kVK_ANSI_X, kVK_ANSI_Y, kVK_ANSI_Z
+};
+constexpr int kDigitKeys[10] = {
+    kVK_ANSI_0, kVK_ANSI_1, kVK_ANSI_2, kVK_ANSI_3, kVK_ANSI_4,
+    kVK_ANSI_5, kVK_ANSI_6, kVK_ANSI_7, kVK_ANSI_8, kVK_ANSI_9
+};
+#endif
+
+bool characterKey(char c, int& key_code) {
+    bool letter = c >= 'a' && c <= 'z';
+    bool digit = c >= '0' && c <= '9';
+    if (!letter && !digit) return false;
+#ifdef _WIN32
+    // Virtual keys for letters are the upper-case ASCII codes
+    key_code = letter ? c - 'a' + 'A' : c;
+#elif __linux__
+    // Latin-1 keysyms are the ASCII codes
+    key_code = letter ? XK_a + (c - 'a') : XK_0 + (c - '0');
+#elif __APPLE__
+    key_code = letter ? kLetterKeys[c - 'a'] : kDigitKeys[c - '0'];
+#else
+    key_code = c;
+#endif
+    return true;
+}
+
+} // namespace
+
+bool keyCodeFromName(std::string_view name, int& key_code) {
+    if (name.size() == 1) {
+        return characterKey(name[0], key_code);
+    }
+    for (const auto& entry : kNamedKeys) {
+        if (!name.empty() && entry.name == name) {
+            key_code = entry.key_code;
+            return true;
+        }
+    }
+    return false;
+}
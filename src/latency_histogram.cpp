@@ -0,0 +1,78 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iomanip>
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    ++buckets_[bucketFor(nanoseconds / 1000)];
+    ++count_;
+    max_ns_ = std::max(max_ns_, nanoseconds);
+}
+
+void LatencyHistogram::reset() {
+    buckets_.fill(0);
+    count_ = 0;
+    max_ns_ = 0;
+}
+
+uint64_t LatencyHistogram::count() const {
+    return count_;
+}
+
+uint64_t LatencyHistogram::maxNs() const {
+    return max_ns_;
+}
+
+uint64_t LatencyHistogram::percentileNs(double quantile) const {
+    if (count_ == 0) return 0;
+    
+    uint64_t rank = static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(count_)));
+    rank = std::max<uint64_t>(1, std::min(rank, count_));
+    
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            // Never report more than was actually observed
+            return std::min(bucketUpperBound(i) * 1000, max_ns_);
+        }
+    }
+    return max_ns_;
+}
+
+void LatencyHistogram::printRow(std::ostream& out, const char* name) const {
+    out << "  " << std::left << std::setw(14) << name << std::right
+        << std::setw(9) << count_
+        << std::setw(9) << percentileNs(0.50) / 1000
+        << std::setw(9) << percentileNs(0.95) / 1000
+        << std::setw(9) << percentileNs(0.99) / 1000
+        << std::setw(9) << max_ns_ / 1000 << "\n";
+}
+
+size_t LatencyHistogram::bucketFor(uint64_t microseconds) {
+    if (microseconds < 8) {
+        return static_cast<size_t>(microseconds);
+    }
+    
+    // Position of the highest set bit picks the power of two, the next three
+    // bits pick the linear sub-bucket inside it
+    int major = std::bit_width(microseconds) - 1;
+    uint64_t minor = (microseconds >> (major - 3)) & 7;
+    size_t index = 8 + static_cast<size_t>(major - 3) * 8 + static_cast<size_t>(minor);
+    return std::min(index, kBucketCount - 1);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < 8) {
+        return index + 1;
+    }
+    
+    size_t major = (index - 8) / 8 + 3;
+    uint64_t minor = (index - 8) % 8;
+    return (8 + minor + 1) << (major - 3);
+}
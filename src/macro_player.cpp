@@ -0,0 +1,68 @@
+#include "macro_player.h"
+#include <algorithm>
+#include "input_simulator.h"
+
+namespace {
+
+constexpr uint64_t kNsPerMs = 1000000;
+
+} // namespace
+
+MacroPlayer::MacroPlayer()
+    : playing_(0)
+{
+}
+
+bool MacroPlayer::start(std::span<const MacroEvent> events, InputSimulator& output, uint64_t now_ns) {
+    if (events.empty() || events.size() > kMaxMacroEvents || playing_ == kMaxPlaying) {
+        return false;
+    }
+    
+    // Slots [0, playing_) are in use; finished ones are swapped out
+    Playback& playback = playbacks_[playing_++];
+    std::copy(events.begin(), events.end(), playback.events.begin());
+    playback.count = events.size();
+    playback.next = 0;
+    playback.start_ns = now_ns;
+    playback.output = &output;
+    return true;
+}
+
+void MacroPlayer::advance(uint64_t now_ns) {
+    size_t index = 0;
+    while (index < playing_) {
+        Playback& playback = playbacks_[index];
+        while (playback.next < playback.count) {
+            const MacroEvent& event = playback.events[playback.next];
+            uint64_t due_ns = playback.start_ns + event.at_ms * kNsPerMs;
+            if (due_ns > now_ns) break;
+            
+            playback.output->sendCommand(event.command);
+            lateness_.record(now_ns - due_ns);
+            ++playback.next;
+        }
+        
+        if (playback.next == playback.count) {
+            playback = playbacks_[--playing_];
+        } else {
+            ++index;
+        }
+    }
+}
+
+uint64_t MacroPlayer::nextDeadlineNs() const {
+    uint64_t deadline = kNoDeadline;
+    for (size_t index = 0; index < playing_; ++index) {
+        const Playback& playback = playbacks_[index];
+        deadline = std::min(deadline, playback.start_ns + playback.events[playback.next].at_ms * kNsPerMs);
+    }
+    return deadline;
+}
+
+bool MacroPlayer::isPlaying() const {
+    return playing_ > 0;
+}
+
+const LatencyHistogram& MacroPlayer::getLateness() const {
+    return lateness_;
+}
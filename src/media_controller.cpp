@@ -3,12 +3,19 @@
 
 #ifdef _WIN32
 #include <windows.h>
-#elif __linux__
-#include <cstdlib>
-#elif __APPLE__
-#include <cstdlib>
 #endif
 
+namespace {
+
+// Percent per volume_up/volume_down press
+#ifdef __APPLE__
+constexpr int kVolumeStepPercent = 10;
+#else
+constexpr int kVolumeStepPercent = 5;
+#endif
+
+} // namespace
+
 MediaController::MediaController() : is_initialized_(false) {
 }
 
@@ -17,6 +24,21 @@ MediaController::~MediaController() {
 }
 
 bool MediaController::initialize() {
+#ifdef HAVE_DBUS
+    // Transport controls go straight to the player over D-Bus; playerctl
+    // stays as the fallback when no session bus or player is around
+    if (mpris_.connect()) {
+        executor_.setHandler([this](const MediaRequest& request) { return sendMprisCommand(request); });
+    } else {
+        std::cerr << "MPRIS unavailable, falling back to playerctl" << std::endl;
+    }
+#endif
+#if defined(__linux__) || defined(__APPLE__)
+    if (!executor_.start()) {
+        std::cerr << "Failed to start media command worker" << std::endl;
+        return false;
+    }
+#endif
     is_initialized_ = true;
     std::cout << "Media controller initialized successfully" << std::endl;
     return true;
@@ -24,6 +46,12 @@ bool MediaController::initialize() {
 
 void MediaController::shutdown() {
     is_initialized_ = false;
+#if defined(__linux__) || defined(__APPLE__)
+    executor_.stop();
+#endif
+#ifdef HAVE_DBUS
+    mpris_.disconnect();
+#endif
 }
 
 void MediaController::playPause() {
@@ -31,10 +59,8 @@ void MediaController::playPause() {
     
 #ifdef _WIN32
     sendMediaKey(VK_MEDIA_PLAY_PAUSE);
-#elif __linux__
-    sendMediaCommand("playerctl play-pause");
-#elif __APPLE__
-    sendAppleScriptCommand("tell application \"Music\" to playpause");
+#elif defined(__linux__) || defined(__APPLE__)
+    sendMediaCommand(MediaCommand::PlayPause);
 #endif
 }
 
@@ -43,10 +69,8 @@ void MediaController::stop() {
     
 #ifdef _WIN32
     sendMediaKey(VK_MEDIA_STOP);
-#elif __linux__
-    sendMediaCommand("playerctl stop");
-#elif __APPLE__
-    sendAppleScriptCommand("tell application \"Music\" to stop");
+#elif defined(__linux__) || defined(__APPLE__)
+    sendMediaCommand(MediaCommand::Stop);
 #endif
 }
 
@@ -55,10 +79,8 @@ void MediaController::next() {
     
 #ifdef _WIN32
     sendMediaKey(VK_MEDIA_NEXT_TRACK);
-#elif __linux__
-    sendMediaCommand("playerctl next");
-#elif __APPLE__
-    sendAppleScriptCommand("tell application \"Music\" to next track");
+#elif defined(__linux__) || defined(__APPLE__)
+    sendMediaCommand(MediaCommand::Next);
 #endif
 }
 
@@ -67,10 +89,8 @@ void MediaController::previous() {
     
 #ifdef _WIN32
     sendMediaKey(VK_MEDIA_PREV_TRACK);
-#elif __linux__
-    sendMediaCommand("playerctl previous");
-#elif __APPLE__
-    sendAppleScriptCommand("tell application \"Music\" to previous track");
+#elif defined(__linux__) || defined(__APPLE__)
+    sendMediaCommand(MediaCommand::Previous);
 #endif
 }
 
@@ -79,10 +99,8 @@ void MediaController::volumeUp() {
     
 #ifdef _WIN32
     sendMediaKey(VK_VOLUME_UP);
-#elif __linux__
-    sendMediaCommand("pactl set-sink-volume @DEFAULT_SINK@ +5%");
-#elif __APPLE__
-    sendAppleScriptCommand("set volume output volume (output volume of (get volume settings) + 10)");
+#elif defined(__linux__) || defined(__APPLE__)
+    sendMediaCommand(MediaCommand::VolumeStep, kVolumeStepPercent);
 #endif
 }
 
@@ -91,10 +109,8 @@ void MediaController::volumeDown() {
     
 #ifdef _WIN32
     sendMediaKey(VK_VOLUME_DOWN);
-#elif __linux__
-    sendMediaCommand("pactl set-sink-volume @DEFAULT_SINK@ -5%");
-#elif __APPLE__
-    sendAppleScriptCommand("set volume output volume (output volume of (get volume settings) - 10)");
+#elif defined(__linux__) || defined(__APPLE__)
+    sendMediaCommand(MediaCommand::VolumeStep, -kVolumeStepPercent);
 #endif
 }
 
@@ -103,19 +119,26 @@ void MediaController::volumeMute() {
     
 #ifdef _WIN32
     sendMediaKey(VK_VOLUME_MUTE);
-#elif __linux__
-    sendMediaCommand("pactl set-sink-mute @DEFAULT_SINK@ toggle");
-#elif __APPLE__
-    sendAppleScriptCommand("set volume with output muted");
+#elif defined(__linux__) || defined(__APPLE__)
+    sendMediaCommand(MediaCommand::Mute);
 #endif
 }
 
 bool MediaController::isPlaying() const {
+#ifdef HAVE_DBUS
+    return mpris_.isPlaying();
+#else
     // 实现播放状态检测 (平台相关)
     return false;
+#endif
 }
 
 int MediaController::getVolume() const {
+#ifdef HAVE_DBUS
+    // Volume of the active MPRIS player, cached from PropertiesChanged
+    int volume = mpris_.getVolume();
+    if (volume >= 0) return volume;
+#endif
     // 实现音量获取 (平台相关)
     return 50;
 }
@@ -126,18 +149,30 @@ void MediaController::sendMediaKey(unsigned long key) {
     keybd_event(key, 0, 0, 0);
     keybd_event(key, 0, KEYEVENTF_KEYUP, 0);
 }
-#elif __linux__
-void MediaController::sendMediaCommand(const char* command) {
-    if (system(command) != 0) {
-        std::cerr << "Media command execution failed: " << command << std::endl;
+#elif defined(__linux__) || defined(__APPLE__)
+void MediaController::sendMediaCommand(MediaCommand command, int amount) {
+    if (!executor_.post(command, amount)) {
+        std::cerr << "Media command queue full, dropping request" << std::endl;
     }
 }
-#elif __APPLE__
-void MediaController::sendAppleScriptCommand(const char* script) {
-    char command[512];
-    snprintf(command, sizeof(command), "osascript -e '%s'", script);
-    if (system(command) != 0) {
-        std::cerr << "AppleScript command execution failed: " << script << std::endl;
+#endif
+
+#ifdef HAVE_DBUS
+bool MediaController::sendMprisCommand(const MediaRequest& request) {
+    // System volume stays with pactl; MPRIS only covers transport
+    switch (request.command) {
+        case MediaCommand::PlayPause:
+            return mpris_.sendPlayerCommand("PlayPause");
+        case MediaCommand::Stop:
+            return mpris_.sendPlayerCommand("Stop");
+        case MediaCommand::Next:
+            return mpris_.sendPlayerCommand("Next");
+        case MediaCommand::Previous:
+            return mpris_.sendPlayerCommand("Previous");
+        case MediaCommand::VolumeStep:
+        case MediaCommand::Mute:
+            return false;
     }
+    return false;
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,182 @@
+#include "media_executor.h"
+#include <iostream>
+#include <string>
+#include <utility>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <spawn.h>
+#include <sys/wait.h>
+extern char** environ;
+#endif
+
+namespace {
+
+#if defined(__linux__) || defined(__APPLE__)
+void spawnAndWait(const char* const* argv) {
+    pid_t pid;
+    int result = posix_spawnp(&pid, argv[0], nullptr, nullptr,
+                              const_cast<char* const*>(argv), environ);
+    if (result != 0) {
+        std::cerr << "Media command failed to start: " << argv[0] << std::endl;
+        return;
+    }
+    
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::cerr << "Media command execution failed: " << argv[0] << std::endl;
+    }
+}
+#endif
+
+} // namespace
+
+MediaExecutor::MediaExecutor()
+    : queue_{}
+    , head_(0)
+    , count_(0)
+    , running_(false)
+{
+}
+
+MediaExecutor::~MediaExecutor() {
+    stop();
+}
+
+bool MediaExecutor::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return true;
+    
+    head_ = 0;
+    count_ = 0;
+    running_ = true;
+    worker_ = std::thread(&MediaExecutor::workerLoop, this);
+    return true;
+}
+
+void MediaExecutor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    wake_.notify_one();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void MediaExecutor::setHandler(std::function<bool(const MediaRequest&)> handler) {
+    handler_ = std::move(handler);
+}
+
+bool MediaExecutor::post(MediaCommand command, int amount) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return false;
+        
+        // Fold a volume step into one still waiting at the back of the queue
+        if (command == MediaCommand::VolumeStep && count_ > 0) {
+            MediaRequest& last = queue_[(head_ + count_ - 1) % kQueueCapacity];
+            if (last.command == MediaCommand::VolumeStep) {
+                last.amount += amount;
+                return true;
+            }
+        }
+        
+        if (count_ == kQueueCapacity) {
+            return false;
+        }
+        
+        queue_[(head_ + count_) % kQueueCapacity] = {command, amount};
+        ++count_;
+    }
+    wake_.notify_one();
+    return true;
+}
+
+void MediaExecutor::workerLoop() {
+    for (;;) {
+        MediaRequest request;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return count_ > 0 || !running_; });
+            // Pending requests are dropped on shutdown rather than delaying exit
+            if (!running_) return;
+            
+            request = queue_[head_];
+            head_ = (head_ + 1) % kQueueCapacity;
+            --count_;
+        }
+        execute(request);
+    }
+}
+
+void MediaExecutor::execute(const MediaRequest& request) {
+    if (handler_ && handler_(request)) return;
+    
+#ifdef __linux__
+    switch (request.command) {
+        case MediaCommand::PlayPause: {
+            const char* argv[] = {"playerctl", "play-pause", nullptr};
+            spawnAndWait(argv);
+            break;
+        }
+        case MediaCommand::Stop: {
+            const char* argv[] = {"playerctl", "stop", nullptr};
+            spawnAndWait(argv);
+            break;
+        }
+        case MediaCommand::Next: {
+            const char* argv[] = {"playerctl", "next", nullptr};
+            spawnAndWait(argv);
+            break;
+        }
+        case MediaCommand::Previous: {
+            const char* argv[] = {"playerctl", "previous", nullptr};
+            spawnAndWait(argv);
+            break;
+        }
+        case MediaCommand::VolumeStep: {
+            if (request.amount == 0) break;  // up and down cancelled out
+            std::string step = (request.amount > 0 ? "+" : "") + std::to_string(request.amount) + "%";
+            const char* argv[] = {"pactl", "set-sink-volume", "@DEFAULT_SINK@", step.c_str(), nullptr};
+            spawnAndWait(argv);
+            break;
+        }
+        case MediaCommand::Mute: {
+            const char* argv[] = {"pactl", "set-sink-mute", "@DEFAULT_SINK@", "toggle", nullptr};
+            spawnAndWait(argv);
+            break;
+        }
+    }
+#elif __APPLE__
+    std::string script;
+    switch (request.command) {
+        case MediaCommand::PlayPause:
+            script = "tell application \"Music\" to playpause";
+            break;
+        case MediaCommand::Stop:
+            script = "tell application \"Music\" to stop";
+            break;
+        case MediaCommand::Next:
+            script = "tell application \"Music\" to next track";
+            break;
+        case MediaCommand::Previous:
+            script = "tell application \"Music\" to previous track";
+            break;
+        case MediaCommand::VolumeStep:
+            if (request.amount == 0) return;
+            script = "set volume output volume (output volume of (get volume settings) " +
+                     std::string(request.amount > 0 ? "+ " : "- ") +
+                     std::to_string(request.amount > 0 ? request.amount : -request.amount) + ")";
+            break;
+        case MediaCommand::Mute:
+            script = "set volume with output muted";
+            break;
+    }
+    const char* argv[] = {"osascript", "-e", script.c_str(), nullptr};
+    spawnAndWait(argv);
+#else
+    (void)request;
+#endif
+}
@@ -0,0 +1,355 @@
+#include "mpris_client.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+constexpr const char* kMprisPrefix = "org.mpris.MediaPlayer2.";
+constexpr const char* kMprisPath = "/org/mpris/MediaPlayer2";
+constexpr const char* kPlayerInterface = "org.mpris.MediaPlayer2.Player";
+constexpr const char* kPropertiesInterface = "org.freedesktop.DBus.Properties";
+
+constexpr const char* kPropertiesMatch =
+    "type='signal',interface='org.freedesktop.DBus.Properties',"
+    "member='PropertiesChanged',path='/org/mpris/MediaPlayer2'";
+constexpr const char* kOwnerMatch =
+    "type='signal',sender='org.freedesktop.DBus',interface='org.freedesktop.DBus',"
+    "member='NameOwnerChanged',arg0namespace='org.mpris.MediaPlayer2'";
+
+// Blocking calls are only made on the dispatch thread, never the input thread
+constexpr int kCallTimeoutMs = 500;
+constexpr int kDispatchTimeoutMs = 50;
+
+bool isMprisName(const char* name) {
+    return name && std::strncmp(name, kMprisPrefix, std::strlen(kMprisPrefix)) == 0;
+}
+
+DBusMessage* callBusMethod(DBusConnection* connection, DBusMessage* message) {
+    DBusError error;
+    dbus_error_init(&error);
+    DBusMessage* reply = dbus_connection_send_with_reply_and_block(connection, message, kCallTimeoutMs, &error);
+    dbus_message_unref(message);
+    if (dbus_error_is_set(&error)) {
+        dbus_error_free(&error);
+        return nullptr;
+    }
+    return reply;
+}
+
+} // namespace
+
+MprisClient::MprisClient()
+    : connection_(nullptr)
+    , running_(false)
+    , playing_(false)
+    , volume_(-1)
+    , has_player_(false)
+    , activity_counter_(0)
+{
+}
+
+MprisClient::~MprisClient() {
+    disconnect();
+}
+
+bool MprisClient::connect() {
+    if (connection_) return true;
+    
+    dbus_threads_init_default();
+    
+    DBusError error;
+    dbus_error_init(&error);
+    connection_ = dbus_bus_get_private(DBUS_BUS_SESSION, &error);
+    if (!connection_) {
+        std::cerr << "D-Bus session bus unavailable: "
+                  << (dbus_error_is_set(&error) ? error.message : "unknown error") << std::endl;
+        dbus_error_free(&error);
+        return false;
+    }
+    dbus_connection_set_exit_on_disconnect(connection_, FALSE);
+    
+    dbus_bus_add_match(connection_, kPropertiesMatch, &error);
+    if (!dbus_error_is_set(&error)) {
+        dbus_bus_add_match(connection_, kOwnerMatch, &error);
+    }
+    if (dbus_error_is_set(&error)) {
+        std::cerr << "D-Bus match rule failed: " << error.message << std::endl;
+        dbus_error_free(&error);
+        dbus_connection_close(connection_);
+        dbus_connection_unref(connection_);
+        connection_ = nullptr;
+        return false;
+    }
+    
+    dbus_connection_add_filter(connection_, &MprisClient::handleMessage, this, nullptr);
+    
+    running_ = true;
+    dispatch_thread_ = std::thread(&MprisClient::dispatchLoop, this);
+    return true;
+}
+
+void MprisClient::disconnect() {
+    if (!connection_) return;
+    
+    running_ = false;
+    if (dispatch_thread_.joinable()) {
+        dispatch_thread_.join();
+    }
+    
+    dbus_connection_remove_filter(connection_, &MprisClient::handleMessage, this);
+    dbus_connection_close(connection_);
+    dbus_connection_unref(connection_);
+    connection_ = nullptr;
+    
+    pending_players_.clear();
+    std::lock_guard<std::mutex> lock(players_mutex_);
+    players_.clear();
+    current_player_.clear();
+    playing_ = false;
+    volume_ = -1;
+    has_player_ = false;
+}
+
+bool MprisClient::isConnected() const {
+    return connection_ != nullptr && running_;
+}
+
+bool MprisClient::isPlaying() const {
+    return playing_.load(std::memory_order_relaxed);
+}
+
+int MprisClient::getVolume() const {
+    return volume_.load(std::memory_order_relaxed);
+}
+
+bool MprisClient::hasPlayer() const {
+    return has_player_.load(std::memory_order_relaxed);
+}
+
+std::string MprisClient::getCurrentPlayer() const {
+    std::lock_guard<std::mutex> lock(players_mutex_);
+    return current_player_;
+}
+
+bool MprisClient::sendPlayerCommand(const char* method) {
+    if (!isConnected()) return false;
+    
+    std::string destination = getCurrentPlayer();
+    if (destination.empty()) return false;
+    
+    DBusMessage* message = dbus_message_new_method_call(destination.c_str(), kMprisPath, kPlayerInterface, method);
+    if (!message) return false;
+    
+    dbus_message_set_no_reply(message, TRUE);
+    bool sent = dbus_connection_send(connection_, message, nullptr);
+    dbus_message_unref(message);
+    if (sent) {
+        dbus_connection_flush(connection_);
+    }
+    return sent;
+}
+
+void MprisClient::dispatchLoop() {
+    discoverPlayers();
+    
+    while (running_) {
+        if (!dbus_connection_read_write_dispatch(connection_, kDispatchTimeoutMs)) {
+            std::cerr << "D-Bus session bus disconnected" << std::endl;
+            running_ = false;
+        }
+        addPendingPlayers();
+    }
+}
+
+void MprisClient::discoverPlayers() {
+    DBusMessage* reply = callBusMethod(connection_, dbus_message_new_method_call(
+        "org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus", "ListNames"));
+    if (!reply) return;
+    
+    DBusMessageIter args;
+    DBusMessageIter names;
+    if (dbus_message_iter_init(reply, &args) && dbus_message_iter_get_arg_type(&args) == DBUS_TYPE_ARRAY) {
+        dbus_message_iter_recurse(&args, &names);
+        while (dbus_message_iter_get_arg_type(&names) == DBUS_TYPE_STRING) {
+            const char* name = nullptr;
+            dbus_message_iter_get_basic(&names, &name);
+            if (isMprisName(name)) {
+                addPlayer(name, "");
+            }
+            dbus_message_iter_next(&names);
+        }
+    }
+    dbus_message_unref(reply);
+}
+
+void MprisClient::addPendingPlayers() {
+    // addPlayer() dispatches nothing while it waits for replies, so no new
+    // names are queued behind our back
+    for (const auto& pending : pending_players_) {
+        addPlayer(pending.bus_name, pending.owner);
+    }
+    pending_players_.clear();
+}
+
+void MprisClient::addPlayer(const std::string& bus_name, const std::string& owner) {
+    Player player{bus_name, owner, false, -1.0, 0};
+    
+    // Signals carry the unique sender name, so resolve it once up front
+    if (player.owner.empty()) {
+        DBusMessage* call = dbus_message_new_method_call(
+            "org.freedesktop.DBus", "/org/freedesktop/DBus", "org.freedesktop.DBus", "GetNameOwner");
+        const char* name = bus_name.c_str();
+        dbus_message_append_args(call, DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID);
+        if (DBusMessage* reply = callBusMethod(connection_, call)) {
+            const char* unique = nullptr;
+            DBusError error;
+            dbus_error_init(&error);
+            if (dbus_message_get_args(reply, &error, DBUS_TYPE_STRING, &unique, DBUS_TYPE_INVALID)) {
+                player.owner = unique;
+            }
+            dbus_error_free(&error);
+            dbus_message_unref(reply);
+        }
+    }
+    
+    // Seed the cache; from here on PropertiesChanged keeps it current
+    DBusMessage* call = dbus_message_new_method_call(bus_name.c_str(), kMprisPath, kPropertiesInterface, "GetAll");
+    const char* interface = kPlayerInterface;
+    dbus_message_append_args(call, DBUS_TYPE_STRING, &interface, DBUS_TYPE_INVALID);
+    if (DBusMessage* reply = callBusMethod(connection_, call)) {
+        DBusMessageIter args;
+        DBusMessageIter changed;
+        if (dbus_message_iter_init(reply, &args) && dbus_message_iter_get_arg_type(&args) == DBUS_TYPE_ARRAY) {
+            dbus_message_iter_recurse(&args, &changed);
+            applyProperties(player, &changed);
+        }
+        dbus_message_unref(reply);
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(players_mutex_);
+        players_.push_back(player);
+    }
+    refreshCurrentPlayer();
+}
+
+void MprisClient::removePlayer(const std::string& bus_name) {
+    {
+        std::lock_guard<std::mutex> lock(players_mutex_);
+        for (auto it = players_.begin(); it != players_.end(); ++it) {
+            if (it->bus_name == bus_name) {
+                players_.erase(it);
+                break;
+            }
+        }
+    }
+    refreshCurrentPlayer();
+}
+
+void MprisClient::applyProperties(Player& player, DBusMessageIter* changed) {
+    while (dbus_message_iter_get_arg_type(changed) == DBUS_TYPE_DICT_ENTRY) {
+        DBusMessageIter entry;
+        DBusMessageIter value;
+        const char* key = nullptr;
+        
+        dbus_message_iter_recurse(changed, &entry);
+        dbus_message_iter_get_basic(&entry, &key);
+        dbus_message_iter_next(&entry);
+        dbus_message_iter_recurse(&entry, &value);
+        
+        if (std::strcmp(key, "PlaybackStatus") == 0 && dbus_message_iter_get_arg_type(&value) == DBUS_TYPE_STRING) {
+            const char* status = nullptr;
+            dbus_message_iter_get_basic(&value, &status);
+            bool playing = std::strcmp(status, "Playing") == 0;
+            if (playing && !player.playing) {
+                player.last_active = ++activity_counter_;
+            }
+            player.playing = playing;
+        } else if (std::strcmp(key, "Volume") == 0 && dbus_message_iter_get_arg_type(&value) == DBUS_TYPE_DOUBLE) {
+            dbus_message_iter_get_basic(&value, &player.volume);
+        }
+        
+        dbus_message_iter_next(changed);
+    }
+}
+
+void MprisClient::refreshCurrentPlayer() {
+    std::lock_guard<std::mutex> lock(players_mutex_);
+    
+    // Prefer whatever is playing, then whatever played most recently
+    const Player* current = nullptr;
+    for (const auto& player : players_) {
+        if (!current ||
+            (player.playing && !current->playing) ||
+            (player.playing == current->playing && player.last_active > current->last_active)) {
+            current = &player;
+        }
+    }
+    
+    current_player_ = current ? current->bus_name : std::string();
+    has_player_ = current != nullptr;
+    playing_ = current && current->playing;
+    volume_ = (current && current->volume >= 0.0) ? static_cast<int>(std::lround(current->volume * 100.0)) : -1;
+}
+
+DBusHandlerResult MprisClient::handleMessage(DBusConnection*, DBusMessage* message, void* user_data) {
+    auto* self = static_cast<MprisClient*>(user_data);
+    
+    if (dbus_message_is_signal(message, "org.freedesktop.DBus", "NameOwnerChanged")) {
+        const char* name = nullptr;
+        const char* old_owner = nullptr;
+        const char* new_owner = nullptr;
+        DBusError error;
+        dbus_error_init(&error);
+        if (dbus_message_get_args(message, &error,
+                                  DBUS_TYPE_STRING, &name,
+                                  DBUS_TYPE_STRING, &old_owner,
+                                  DBUS_TYPE_STRING, &new_owner,
+                                  DBUS_TYPE_INVALID) && isMprisName(name)) {
+            // An old owner means the player went away (or was replaced),
+            // a new owner means it (re)appeared. Adding one queries the
+            // player, so that waits until this filter has returned.
+            if (old_owner[0] != '\0') {
+                auto& pending = self->pending_players_;
+                pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                             [&](const Player& player) { return player.bus_name == name; }),
+                              pending.end());
+                self->removePlayer(name);
+            }
+            if (new_owner[0] != '\0') {
+                self->pending_players_.push_back(Player{name, new_owner, false, -1.0, 0});
+            }
+        }
+        dbus_error_free(&error);
+    } else if (dbus_message_is_signal(message, kPropertiesInterface, "PropertiesChanged")) {
+        const char* sender = dbus_message_get_sender(message);
+        DBusMessageIter args;
+        DBusMessageIter changed;
+        const char* interface = nullptr;
+        
+        if (sender && dbus_message_iter_init(message, &args) &&
+            dbus_message_iter_get_arg_type(&args) == DBUS_TYPE_STRING) {
+            dbus_message_iter_get_basic(&args, &interface);
+            if (std::strcmp(interface, kPlayerInterface) == 0 && dbus_message_iter_next(&args) &&
+                dbus_message_iter_get_arg_type(&args) == DBUS_TYPE_ARRAY) {
+                dbus_message_iter_recurse(&args, &changed);
+                
+                {
+                    std::lock_guard<std::mutex> lock(self->players_mutex_);
+                    for (auto& player : self->players_) {
+                        if (player.owner == sender) {
+                            self->applyProperties(player, &changed);
+                            break;
+                        }
+                    }
+                }
+                self->refreshCurrentPlayer();
+            }
+        }
+    }
+    
+    // Other filters/handlers may want these signals too
+    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
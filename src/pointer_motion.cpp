@@ -0,0 +1,64 @@
+#include "pointer_motion.h"
+#include <algorithm>
+#include <cmath>
+
+PointerMotion::PointerMotion()
+    : speed_(kBasePointerSpeed)
+    , ramp_(0.0)
+    , remainder_x_(0.0)
+    , remainder_y_(0.0)
+{
+}
+
+void PointerMotion::setSpeed(float pixels_per_second) {
+    speed_ = pixels_per_second;
+}
+
+float PointerMotion::getSpeed() const {
+    return speed_;
+}
+
+void PointerMotion::setAcceleration(const PointerAcceleration& acceleration) {
+    acceleration_ = acceleration;
+}
+
+void PointerMotion::integrate(float x, float y, float precision, double dt_seconds, int& delta_x, int& delta_y) {
+    // Build the ramp while the stick is held past the threshold, in
+    // proportion to how far past it is; let it fall otherwise
+    double ramp_seconds = std::max(acceleration_.ramp_ms, 1) / 1000.0;
+    double magnitude = std::sqrt(static_cast<double>(x) * x + static_cast<double>(y) * y);
+    double headroom = 1.0 - acceleration_.threshold;
+    double excess = headroom > 0.0 ? (magnitude - acceleration_.threshold) / headroom : 0.0;
+    if (excess > 0.0) {
+        ramp_ += std::min(excess, 1.0) * dt_seconds / ramp_seconds;
+    } else {
+        ramp_ -= 4.0 * dt_seconds / ramp_seconds;
+    }
+    ramp_ = std::clamp(ramp_, 0.0, 1.0);
+    
+    double gain = getAccelerationGain();
+    double precision_scale = 1.0 + (acceleration_.precision_gain - 1.0) * std::clamp(precision, 0.0f, 1.0f);
+    double step = speed_ * gain * precision_scale * dt_seconds;
+    remainder_x_ += static_cast<double>(x) * step;
+    remainder_y_ += static_cast<double>(y) * step;
+    
+    // Truncate toward zero so the carried remainder keeps the sign of the motion
+    double whole_x = std::trunc(remainder_x_);
+    double whole_y = std::trunc(remainder_y_);
+    remainder_x_ -= whole_x;
+    remainder_y_ -= whole_y;
+    
+    delta_x = static_cast<int>(whole_x);
+    delta_y = static_cast<int>(whole_y);
+}
+
+void PointerMotion::reset() {
+    ramp_ = 0.0;
+    remainder_x_ = 0.0;
+    remainder_y_ = 0.0;
+}
+
+float PointerMotion::getAccelerationGain() const {
+    // Ease in so the first moments of a held stick stay controllable
+    return static_cast<float>(1.0 + (acceleration_.max_gain - 1.0) * ramp_ * ramp_);
+}
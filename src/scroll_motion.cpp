@@ -0,0 +1,32 @@
+#include "scroll_motion.h"
+#include <cmath>
+
+ScrollMotion::ScrollMotion()
+    : speed_(kBaseScrollSpeed)
+    , remainder_x_(0.0)
+    , remainder_y_(0.0)
+{
+}
+
+void ScrollMotion::setSpeed(float notches_per_second) {
+    speed_ = notches_per_second;
+}
+
+void ScrollMotion::integrate(float horizontal, float vertical, double dt_seconds, int& units_x, int& units_y) {
+    double step = static_cast<double>(speed_) * kWheelUnitsPerNotch * dt_seconds;
+    remainder_x_ += horizontal * step;
+    remainder_y_ += vertical * step;
+    
+    double whole_x = std::trunc(remainder_x_);
+    double whole_y = std::trunc(remainder_y_);
+    remainder_x_ -= whole_x;
+    remainder_y_ -= whole_y;
+    
+    units_x = static_cast<int>(whole_x);
+    units_y = static_cast<int>(whole_y);
+}
+
+void ScrollMotion::reset() {
+    remainder_x_ = 0.0;
+    remainder_y_ = 0.0;
+}
@@ -0,0 +1,81 @@
+#include "stick_response.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+float evaluateCurve(const StickSettings& settings, float t) {
+    switch (settings.curve) {
+        case ResponseCurve::Linear:
+            break;
+        case ResponseCurve::Power:
+            return std::pow(t, settings.curve_exponent);
+        case ResponseCurve::SCurve: {
+            float rising = std::pow(t, settings.curve_exponent);
+            float falling = std::pow(1.0f - t, settings.curve_exponent);
+            return rising / (rising + falling);
+        }
+        case ResponseCurve::Custom: {
+            CurvePoint previous{0.0f, 0.0f};
+            for (size_t i = 0; i <= settings.curve_point_count; ++i) {
+                CurvePoint next = i < settings.curve_point_count ? settings.curve_points[i] : CurvePoint{1.0f, 1.0f};
+                if (t <= next.input) {
+                    float span = next.input - previous.input;
+                    float fraction = span > 0.0f ? (t - previous.input) / span : 1.0f;
+                    return previous.output + (next.output - previous.output) * fraction;
+                }
+                previous = next;
+            }
+            return 1.0f;
+        }
+    }
+    return t;
+}
+
+} // namespace
+
+StickResponse::StickResponse() {
+    configure(StickSettings{});
+}
+
+void StickResponse::configure(const StickSettings& settings) {
+    for (size_t i = 0; i <= kTableSize; ++i) {
+        float t = static_cast<float>(i) / kTableSize;
+        table_[i] = std::clamp(evaluateCurve(settings, t), 0.0f, 1.0f);
+    }
+    
+    shape_ = settings.dead_zone_shape;
+    dead_zone_ = settings.dead_zone;
+    offset_ = shape_ == DeadZoneShape::ScaledRadial ? dead_zone_ : 0.0f;
+    float range = 1.0f - settings.outer_dead_zone - offset_;
+    scale_ = range > 0.0f ? 1.0f / range : 1.0f;
+}
+
+float StickResponse::lookup(float magnitude) const {
+    float position = std::clamp((magnitude - offset_) * scale_, 0.0f, 1.0f) * kTableSize;
+    size_t index = std::min(static_cast<size_t>(position), kTableSize - 1);
+    float fraction = position - static_cast<float>(index);
+    return table_[index] + (table_[index + 1] - table_[index]) * fraction;
+}
+
+void StickResponse::apply(float x, float y, float& out_x, float& out_y) const {
+    if (shape_ == DeadZoneShape::Axial) {
+        float abs_x = std::fabs(x);
+        float abs_y = std::fabs(y);
+        out_x = abs_x > dead_zone_ ? std::copysign(lookup(abs_x), x) : 0.0f;
+        out_y = abs_y > dead_zone_ ? std::copysign(lookup(abs_y), y) : 0.0f;
+        return;
+    }
+    
+    float squared = x * x + y * y;
+    if (squared <= dead_zone_ * dead_zone_ || squared == 0.0f) {
+        out_x = 0.0f;
+        out_y = 0.0f;
+        return;
+    }
+    // Keep the direction, reshape only the distance from centre
+    float magnitude = std::sqrt(squared);
+    float gain = lookup(magnitude) / magnitude;
+    out_x = x * gain;
+    out_y = y * gain;
+}
@@ -0,0 +1,75 @@
+#include "timer_wheel.h"
+#include <algorithm>
+
+TimerWheel::TimerWheel()
+    : entries_{}
+    , cursor_tick_(0)
+    , pending_count_(0)
+    , next_deadline_ns_(kNoDeadline)
+    , next_deadline_valid_(true)
+{
+    heads_.fill(kEnd);
+}
+
+void TimerWheel::schedule(size_t id, uint64_t due_ns) {
+    if (id >= kCapacity) return;
+    uint16_t index = static_cast<uint16_t>(id);
+    if (entries_[index].pending) {
+        unlink(index);
+    }
+    
+    // Overdue timers go in the slot advance() looks at next
+    uint64_t tick = std::max(due_ns / kSlotNs, cursor_tick_);
+    Entry& entry = entries_[index];
+    entry.due_ns = due_ns;
+    entry.slot = static_cast<uint16_t>(tick % kSlotCount);
+    entry.prev = kEnd;
+    entry.next = heads_[entry.slot];
+    entry.pending = true;
+    if (entry.next != kEnd) {
+        entries_[entry.next].prev = index;
+    }
+    heads_[entry.slot] = index;
+    ++pending_count_;
+    next_deadline_valid_ = false;
+}
+
+void TimerWheel::cancel(size_t id) {
+    if (id < kCapacity && entries_[id].pending) {
+        unlink(static_cast<uint16_t>(id));
+    }
+}
+
+bool TimerWheel::isPending(size_t id) const {
+    return id < kCapacity && entries_[id].pending;
+}
+
+uint64_t TimerWheel::nextDeadlineNs() const {
+    if (!next_deadline_valid_) {
+        next_deadline_ns_ = kNoDeadline;
+        if (pending_count_ > 0) {
+            for (const auto& entry : entries_) {
+                if (entry.pending) next_deadline_ns_ = std::min(next_deadline_ns_, entry.due_ns);
+            }
+        }
+        next_deadline_valid_ = true;
+    }
+    return next_deadline_ns_;
+}
+
+void TimerWheel::unlink(uint16_t id) {
+    Entry& entry = entries_[id];
+    if (entry.prev != kEnd) {
+        entries_[entry.prev].next = entry.next;
+    } else {
+        heads_[entry.slot] = entry.next;
+    }
+    if (entry.next != kEnd) {
+        entries_[entry.next].prev = entry.prev;
+    }
+    entry.prev = kEnd;
+    entry.next = kEnd;
+    entry.pending = false;
+    --pending_count_;
+    next_deadline_valid_ = false;
+}
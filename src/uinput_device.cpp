@@ -0,0 +1,247 @@
+#include "uinput_device.h"
+#include <cerrno>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <linux/uinput.h>
+#include <X11/keysym.h>
+#include <X11/XF86keysym.h>
+
+namespace {
+
+struct KeysymMapping {
+    unsigned long keysym;
+    unsigned short code;
+};
+
+constexpr KeysymMapping kKeysymMap[] = {
+    {XK_Alt_L, KEY_LEFTALT},
+    {XK_Alt_R, KEY_RIGHTALT},
+    {XK_Control_L, KEY_LEFTCTRL},
+    {XK_Control_R, KEY_RIGHTCTRL},
+    {XK_Shift_L, KEY_LEFTSHIFT},
+    {XK_Shift_R, KEY_RIGHTSHIFT},
+    {XK_Super_L, KEY_LEFTMETA},
+    {XK_Super_R, KEY_RIGHTMETA},
+    {XK_Tab, KEY_TAB},
+    {XK_Escape, KEY_ESC},
+    {XK_Return, KEY_ENTER},
+    {XK_space, KEY_SPACE},
+    {XK_BackSpace, KEY_BACKSPACE},
+    {XK_Delete, KEY_DELETE},
+    {XK_Insert, KEY_INSERT},
+    {XK_Home, KEY_HOME},
+    {XK_End, KEY_END},
+    {XK_Page_Up, KEY_PAGEUP},
+    {XK_Page_Down, KEY_PAGEDOWN},
+    {XK_Left, KEY_LEFT},
+    {XK_Right, KEY_RIGHT},
+    {XK_Up, KEY_UP},
+    {XK_Down, KEY_DOWN},
+    {XK_Print, KEY_SYSRQ},
+    {XK_F1, KEY_F1}, {XK_F2, KEY_F2}, {XK_F3, KEY_F3}, {XK_F4, KEY_F4},
+    {XK_F5, KEY_F5}, {XK_F6, KEY_F6}, {XK_F7, KEY_F7}, {XK_F8, KEY_F8},
+    {XK_F9, KEY_F9}, {XK_F10, KEY_F10}, {XK_F11, KEY_F11}, {XK_F12, KEY_F12},
+    {XK_a, KEY_A}, {XK_b, KEY_B}, {XK_c, KEY_C}, {XK_d, KEY_D}, {XK_e, KEY_E},
+    {XK_f, KEY_F}, {XK_g, KEY_G}, {XK_h, KEY_H}, {XK_i, KEY_I}, {XK_j, KEY_J},
+    {XK_k, KEY_K}, {XK_l, KEY_L}, {XK_m, KEY_M}, {XK_n, KEY_N}, {XK_o, KEY_O},
+    {XK_p, KEY_P}, {XK_q, KEY_Q}, {XK_r, KEY_R}, {XK_s, KEY_S}, {XK_t, KEY_T},
+    {XK_u, KEY_U}, {XK_v, KEY_V}, {XK_w, KEY_W}, {XK_x, KEY_X}, {XK_y, KEY_Y},
+    {XK_z, KEY_Z},
+    {XK_0, KEY_0}, {XK_1, KEY_1}, {XK_2, KEY_2}, {XK_3, KEY_3}, {XK_4, KEY_4},
+    {XK_5, KEY_5}, {XK_6, KEY_6}, {XK_7, KEY_7}, {XK_8, KEY_8}, {XK_9, KEY_9},
+    {XF86XK_AudioPlay, KEY_PLAYPAUSE},
+    {XF86XK_AudioStop, KEY_STOPCD},
+    {XF86XK_AudioNext, KEY_NEXTSONG},
+    {XF86XK_AudioPrev, KEY_PREVIOUSSONG},
+    {XF86XK_AudioRaiseVolume, KEY_VOLUMEUP},
+    {XF86XK_AudioLowerVolume, KEY_VOLUMEDOWN},
+    {XF86XK_AudioMute, KEY_MUTE},
+    {XF86XK_Back, KEY_BACK},
+    {XF86XK_Forward, KEY_FORWARD},
+};
+
+// Identity of the virtual device. Vendor 0 is not assigned to any USB
+// vendor, so gamepad databases (SDL, Steam Input, udev hwdb) never take
+// the bridge's own output for a controller; the product id tells it apart
+// from other virtual devices.
+constexpr unsigned short kVirtualVendorId = 0x0000;
+constexpr unsigned short kVirtualProductId = 0x5842;  // "XB"
+
+} // namespace
+
+unsigned short keysymToEvdev(unsigned long keysym) {
+    // Upper-case letters share the key with their lower-case keysym
+    if (keysym >= XK_A && keysym <= XK_Z) {
+        keysym += XK_a - XK_A;
+    }
+    for (const auto& mapping : kKeysymMap) {
+        if (mapping.keysym == keysym) return mapping.code;
+    }
+    return 0;
+}
+
+UinputDevice::UinputDevice()
+    : fd_(-1)
+    , owns_device_(false)
+    , events_{}
+    , event_count_(0)
+{
+}
+
+UinputDevice::~UinputDevice() {
+    close();
+}
+
+bool UinputDevice::open(const char* name) {
+    close();
+    
+    int fd = ::open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Cannot open /dev/uinput: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    
+    bool ok = ioctl(fd, UI_SET_EVBIT, EV_KEY) == 0 &&
+              ioctl(fd, UI_SET_EVBIT, EV_REL) == 0 &&
+              ioctl(fd, UI_SET_EVBIT, EV_SYN) == 0;
+    
+    for (int button : {BTN_LEFT, BTN_RIGHT, BTN_MIDDLE}) {
+        ok = ok && ioctl(fd, UI_SET_KEYBIT, button) == 0;
+    }
+    for (const auto& mapping : kKeysymMap) {
+        ok = ok && ioctl(fd, UI_SET_KEYBIT, mapping.code) == 0;
+    }
+    for (int axis : {REL_X, REL_Y, REL_WHEEL, REL_HWHEEL}) {
+        ok = ok && ioctl(fd, UI_SET_RELBIT, axis) == 0;
+    }
+#ifdef REL_WHEEL_HI_RES
+    ok = ok && ioctl(fd, UI_SET_RELBIT, REL_WHEEL_HI_RES) == 0;
+    ok = ok && ioctl(fd, UI_SET_RELBIT, REL_HWHEEL_HI_RES) == 0;
+#endif
+    
+    uinput_setup setup{};
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = kVirtualVendorId;
+    setup.id.product = kVirtualProductId;
+    setup.id.version = 1;
+    std::strncpy(setup.name, name, UINPUT_MAX_NAME_SIZE - 1);
+    
+    ok = ok && ioctl(fd, UI_DEV_SETUP, &setup) == 0 && ioctl(fd, UI_DEV_CREATE) == 0;
+    if (!ok) {
+        std::cerr << "Failed to create uinput device: " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        return false;
+    }
+    
+    fd_ = fd;
+    owns_device_ = true;
+    return true;
+}
+
+void UinputDevice::adopt(int fd) {
+    close();
+    fd_ = fd;
+    owns_device_ = false;
+}
+
+void UinputDevice::close() {
+    if (fd_ < 0) return;
+    
+    if (owns_device_) {
+        ioctl(fd_, UI_DEV_DESTROY);
+        ::close(fd_);
+    }
+    fd_ = -1;
+    owns_device_ = false;
+}
+
+bool UinputDevice::isOpen() const {
+    return fd_ >= 0;
+}
+
+bool UinputDevice::submit(const OutputBuffer& commands) {
+    if (fd_ < 0 || commands.empty()) return false;
+    
+    event_count_ = 0;
+    pressed_this_frame_.reset();
+    
+    for (const auto& command : commands) {
+        switch (command.type) {
+            case OutputCommandType::MouseMove:
+                if (command.x != 0) emit(EV_REL, REL_X, command.x);
+                if (command.y != 0) emit(EV_REL, REL_Y, command.y);
+                break;
+            case OutputCommandType::MouseWarp:
+                // A relative device has no notion of absolute position
+                break;
+            case OutputCommandType::MouseButton:
+                if (command.button == MouseButton::Left) {
+                    emitKey(BTN_LEFT, command.down);
+                } else if (command.button == MouseButton::Right) {
+                    emitKey(BTN_RIGHT, command.down);
+                } else {
+                    emitKey(BTN_MIDDLE, command.down);
+                }
+                break;
+            case OutputCommandType::Scroll: {
+                // Hi-res axes get every unit; the legacy axes a notch each
+                // time a whole one has built up, as a real hi-res mouse does
+                int notches_y = wheel_notches_y_.add(command.y, kWheelUnitsPerNotch);
+                int notches_x = wheel_notches_x_.add(command.x, kWheelUnitsPerNotch);
+#ifdef REL_WHEEL_HI_RES
+                if (command.y != 0) emit(EV_REL, REL_WHEEL_HI_RES, command.y);
+                if (command.x != 0) emit(EV_REL, REL_HWHEEL_HI_RES, command.x);
+#endif
+                if (notches_y != 0) emit(EV_REL, REL_WHEEL, notches_y);
+                if (notches_x != 0) emit(EV_REL, REL_HWHEEL, notches_x);
+                break;
+            }
+            case OutputCommandType::Key: {
+                unsigned short code = keysymToEvdev(static_cast<unsigned long>(command.x));
+                if (code != 0) {
+                    emitKey(code, command.down);
+                }
+                break;
+            }
+        }
+    }
+    
+    if (event_count_ == 0) return true;
+    emit(EV_SYN, SYN_REPORT, 0);
+    
+    ssize_t size = static_cast<ssize_t>(event_count_ * sizeof(input_event));
+    ssize_t written = write(fd_, events_, static_cast<size_t>(size));
+    if (written != size) {
+        std::cerr << "uinput write failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void UinputDevice::emit(unsigned short type, unsigned short code, int value) {
+    if (event_count_ >= kMaxEvents) return;
+    
+    input_event& event = events_[event_count_++];
+    event = input_event{};
+    event.type = type;
+    event.code = code;
+    event.value = value;
+}
+
+void UinputDevice::emitKey(unsigned short code, bool down) {
+    // Readers such as libinput diff key state per SYN frame, so a press and
+    // release of the same key inside one frame would cancel out. Close the
+    // frame before the release in that case.
+    if (!down && pressed_this_frame_.test(code)) {
+        emit(EV_SYN, SYN_REPORT, 0);
+        pressed_this_frame_.reset();
+    }
+    if (down) {
+        pressed_this_frame_.set(code);
+    }
+    emit(EV_KEY, code, down ? 1 : 0);
+}
@@ -0,0 +1,177 @@
+// AutoRepeat schedules from the press timestamp, so with synthetic times the
+// repeats land on an exact grid: first at delay_ms (or one interval for
+// turbo), then every 1/rate_hz, with a stall skipping what it missed.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "auto_repeat.h"
+#include "test_util.h"
+
+namespace {
+
+constexpr uint64_t kNsPerMs = 1000000;
+
+struct Firing {
+    size_t pad;
+    ButtonAction action;
+    uint64_t at_ns;
+};
+
+ButtonBinding binding(ButtonAction action) {
+    ButtonBinding result;
+    result.action = action;
+    return result;
+}
+
+RepeatSettings repeat(uint32_t delay_ms, uint32_t rate_hz) {
+    RepeatSettings settings;
+    settings.delay_ms = delay_ms;
+    settings.rate_hz = rate_hz;
+    return settings;
+}
+
+RepeatSettings turbo(uint32_t rate_hz) {
+    RepeatSettings settings;
+    settings.rate_hz = rate_hz;
+    settings.turbo = true;
+    return settings;
+}
+
+// Advance every step_ns from from_ns through to_ns, listing the repeats
+std::vector<Firing> run(AutoRepeat& repeats, uint64_t from_ns, uint64_t to_ns, uint64_t step_ns) {
+    std::vector<Firing> fired;
+    for (uint64_t now_ns = from_ns; now_ns <= to_ns; now_ns += step_ns) {
+        repeats.advance(now_ns, [&](size_t pad, const ButtonBinding& fired_binding) {
+            fired.push_back({pad, fired_binding.action, now_ns});
+        });
+    }
+    return fired;
+}
+
+void testFirstRepeatAtDelay() {
+    AutoRepeat repeats;
+    uint64_t pressed_ns = 1000 * kNsPerMs;
+    repeats.start(0, GamepadButton::DpadDown, binding(ButtonAction::VolumeDown), repeat(400, 20), pressed_ns);
+    CHECK_EQ(repeats.nextDeadlineNs(), pressed_ns + 400 * kNsPerMs);
+    
+    // Nothing before delay_ms, then every 50 ms on the press's grid
+    std::vector<Firing> fired = run(repeats, pressed_ns, pressed_ns + 399 * kNsPerMs, kNsPerMs);
+    CHECK(fired.empty());
+    fired = run(repeats, pressed_ns + 400 * kNsPerMs, pressed_ns + 600 * kNsPerMs, kNsPerMs);
+    CHECK_EQ(fired.size(), size_t{5});
+    for (size_t index = 0; index < fired.size(); ++index) {
+        CHECK_EQ(fired[index].at_ns, pressed_ns + (400 + 50 * index) * kNsPerMs);
+        CHECK_EQ(fired[index].pad, size_t{0});
+        CHECK(fired[index].action == ButtonAction::VolumeDown);
+    }
+}
+
+void testSteadyRate() {
+    // 30 Hz does not divide a millisecond grid, and the press is mid-slot:
+    // each repeat still fires in the first 1 ms frame at or after
+    // pressed + delay + k/30 s, without drift over many repeats
+    AutoRepeat repeats;
+    uint64_t pressed_ns = 5 * kNsPerMs + 300000;
+    uint64_t interval_ns = 1000000000ull / 30;
+    repeats.start(1, GamepadButton::A, binding(ButtonAction::LeftClick), repeat(250, 30), pressed_ns);
+    
+    std::vector<Firing> fired = run(repeats, 0, pressed_ns + 250 * kNsPerMs + 10 * interval_ns + kNsPerMs, kNsPerMs);
+    CHECK_EQ(fired.size(), size_t{11});
+    for (size_t index = 0; index < fired.size(); ++index) {
+        uint64_t due_ns = pressed_ns + 250 * kNsPerMs + index * interval_ns;
+        CHECK(fired[index].at_ns >= due_ns);
+        CHECK(fired[index].at_ns < due_ns + kNsPerMs);
+        CHECK_EQ(fired[index].pad, size_t{1});
+    }
+    
+    // Coarse 16 ms frames see the same number of repeats, each once
+    AutoRepeat coarse;
+    coarse.start(1, GamepadButton::A, binding(ButtonAction::LeftClick), repeat(250, 30), pressed_ns);
+    std::vector<Firing> coarse_fired = run(coarse, 0, pressed_ns + 250 * kNsPerMs + 10 * interval_ns + 16 * kNsPerMs,
+                                           16 * kNsPerMs);
+    CHECK_EQ(coarse_fired.size(), size_t{11});
+}
+
+void testTurboStartsOneInterval() {
+    // Turbo ignores delay_ms: first repeat one interval (100 ms) after the press
+    AutoRepeat repeats;
+    uint64_t pressed_ns = 2000 * kNsPerMs;
+    RepeatSettings settings = turbo(10);
+    settings.delay_ms = 700;
+    repeats.start(0, GamepadButton::X, binding(ButtonAction::RightClick), settings, pressed_ns);
+    CHECK_EQ(repeats.nextDeadlineNs(), pressed_ns + 100 * kNsPerMs);
+    
+    std::vector<Firing> fired = run(repeats, pressed_ns, pressed_ns + 350 * kNsPerMs, kNsPerMs);
+    CHECK_EQ(fired.size(), size_t{3});
+    for (size_t index = 0; index < fired.size(); ++index) {
+        CHECK_EQ(fired[index].at_ns, pressed_ns + 100 * (index + 1) * kNsPerMs);
+    }
+}
+
+void testStallSkipsMissedRepeats() {
+    AutoRepeat repeats;
+    repeats.start(0, GamepadButton::DpadUp, binding(ButtonAction::VolumeUp), repeat(100, 100), 0);
+    std::vector<Firing> fired = run(repeats, 0, 150 * kNsPerMs, kNsPerMs);
+    CHECK_EQ(fired.size(), size_t{6});
+    
+    // 2 s without a frame (two laps of the wheel): one repeat, not 200, and
+    // the next one back on the press's 10 ms grid
+    fired = run(repeats, 2155 * kNsPerMs, 2155 * kNsPerMs, kNsPerMs);
+    CHECK_EQ(fired.size(), size_t{1});
+    CHECK_EQ(repeats.nextDeadlineNs(), 2160 * kNsPerMs);
+    
+    fired = run(repeats, 2156 * kNsPerMs, 2180 * kNsPerMs, kNsPerMs);
+    CHECK_EQ(fired.size(), size_t{3});
+    if (fired.size() == 3) {
+        CHECK_EQ(fired[0].at_ns, 2160 * kNsPerMs);
+        CHECK_EQ(fired[2].at_ns, 2180 * kNsPerMs);
+    }
+}
+
+void testStopCancels() {
+    AutoRepeat repeats;
+    repeats.start(0, GamepadButton::B, binding(ButtonAction::Escape), repeat(300, 10), 0);
+    repeats.start(2, GamepadButton::B, binding(ButtonAction::Enter), repeat(300, 10), 0);
+    
+    // Released before the first repeat: nothing fires for pad1's B
+    run(repeats, 0, 200 * kNsPerMs, kNsPerMs);
+    repeats.stop(0, GamepadButton::B);
+    std::vector<Firing> fired = run(repeats, 201 * kNsPerMs, 450 * kNsPerMs, kNsPerMs);
+    CHECK_EQ(fired.size(), size_t{2});
+    for (const auto& firing : fired) {
+        CHECK_EQ(firing.pad, size_t{2});
+        CHECK(firing.action == ButtonAction::Enter);
+    }
+    
+    // Released between repeats: no more, and nothing left to wake for
+    repeats.stop(2, GamepadButton::B);
+    CHECK_EQ(repeats.nextDeadlineNs(), TimerWheel::kNoDeadline);
+    fired = run(repeats, 451 * kNsPerMs, 2000 * kNsPerMs, kNsPerMs);
+    CHECK(fired.empty());
+    
+    // Stopping a button that is not repeating is harmless
+    repeats.stop(3, GamepadButton::Y);
+    repeats.stop(kMaxGamepads, GamepadButton::Y);
+}
+
+void testIgnoredStarts() {
+    // Off settings, unmapped bindings and unknown pads never schedule
+    AutoRepeat repeats;
+    repeats.start(0, GamepadButton::A, binding(ButtonAction::LeftClick), RepeatSettings{}, 0);
+    repeats.start(0, GamepadButton::B, ButtonBinding{}, repeat(100, 10), 0);
+    repeats.start(kMaxGamepads, GamepadButton::A, binding(ButtonAction::LeftClick), repeat(100, 10), 0);
+    CHECK_EQ(repeats.nextDeadlineNs(), TimerWheel::kNoDeadline);
+    CHECK(run(repeats, 0, 500 * kNsPerMs, kNsPerMs).empty());
+}
+
+} // namespace
+
+int main() {
+    testFirstRepeatAtDelay();
+    testSteadyRate();
+    testTurboStartsOneInterval();
+    testStallSkipsMissedRepeats();
+    testStopCancels();
+    testIgnoredStarts();
+    return testExitCode("auto_repeat_test");
+}
@@ -0,0 +1,220 @@
+// GestureRecognizer decides chords, long presses and double taps from the
+// edge timestamps alone. Each script below is a list of timestamped button
+// edges with the bindings it must produce; every script is played with
+// 1 ms and 16 ms frames and event-driven (waking only for edges and
+// nextDeadlineNs()), and all three must give the same result.
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "gesture_recognizer.h"
+#include "test_util.h"
+
+namespace {
+
+constexpr uint64_t kNsPerMs = 1000000;
+// Every script is over by then
+constexpr uint64_t kScriptEndMs = 1200;
+
+struct Edge {
+    uint32_t at_ms;
+    GamepadButton button;
+    bool down;
+};
+
+struct Fired {
+    ButtonAction action;
+    bool down;
+};
+
+struct Script {
+    const char* name;
+    std::vector<Edge> edges;
+    std::vector<Fired> expected;
+};
+
+std::array<ButtonBinding, kGamepadButtonCount> plainBindings() {
+    std::array<ButtonBinding, kGamepadButtonCount> bindings{};
+    bindings[static_cast<size_t>(GamepadButton::A)].action = ButtonAction::LeftClick;
+    bindings[static_cast<size_t>(GamepadButton::B)].action = ButtonAction::RightClick;
+    bindings[static_cast<size_t>(GamepadButton::X)].action = ButtonAction::Escape;
+    bindings[static_cast<size_t>(GamepadButton::Y)].action = ButtonAction::Enter;
+    bindings[static_cast<size_t>(GamepadButton::LeftShoulder)].action = ButtonAction::MiddleClick;
+    return bindings;
+}
+
+// LB+A is a chord, X has a long press, Y a double tap; B is a plain button
+GestureTable gestureTable() {
+    GestureTable table;
+    table.chords[0].buttons = buttonBit(GamepadButton::LeftShoulder) | buttonBit(GamepadButton::A);
+    table.chords[0].binding.action = ButtonAction::AltTab;
+    table.chord_count = 1;
+    table.hold[static_cast<size_t>(GamepadButton::X)].action = ButtonAction::MediaNext;
+    table.double_tap[static_cast<size_t>(GamepadButton::Y)].action = ButtonAction::Screenshot;
+    table.hold_ms = 400;
+    table.double_tap_ms = 250;
+    table.chord_window_ms = 50;
+    table.compile();
+    return table;
+}
+
+std::string describe(ButtonAction action, bool down) {
+    return std::string(actionName(action)) + (down ? "+ " : "- ");
+}
+
+std::string describe(const std::vector<Fired>& fired) {
+    std::string text;
+    for (const auto& event : fired) {
+        text += describe(event.action, event.down);
+    }
+    return text;
+}
+
+// Play script with a frame every frame_ms, or event-driven for 0, the way
+// GamepadAPI feeds the recognizer, and list what it fired
+std::string play(const GestureTable& table, const Script& script, uint32_t frame_ms) {
+    const auto bindings = plainBindings();
+    GestureRecognizer recognizer;
+    ButtonMask buttons = 0;
+    size_t next_edge = 0;
+    uint64_t now_ns = 0;
+    std::string fired;
+    
+    while (now_ns < kScriptEndMs * kNsPerMs) {
+        if (frame_ms > 0) {
+            now_ns += frame_ms * kNsPerMs;
+        } else {
+            uint64_t next_ns = kScriptEndMs * kNsPerMs;
+            if (next_edge < script.edges.size()) next_ns = script.edges[next_edge].at_ms * kNsPerMs;
+            now_ns = std::min(next_ns, recognizer.nextDeadlineNs(table));
+        }
+        
+        // A frame's edges share one SDL timestamp, so the scripts keep edges
+        // at different times in different 16 ms frames
+        ButtonMask pressed = 0;
+        ButtonMask released = 0;
+        uint64_t edge_ns = now_ns;
+        for (; next_edge < script.edges.size() && script.edges[next_edge].at_ms * kNsPerMs <= now_ns; ++next_edge) {
+            const Edge& edge = script.edges[next_edge];
+            if ((pressed | released) != 0) CHECK_EQ(edge.at_ms * kNsPerMs, edge_ns);
+            edge_ns = edge.at_ms * kNsPerMs;
+            ButtonMask bit = buttonBit(edge.button);
+            if (edge.down) {
+                buttons |= bit;
+                pressed |= bit;
+            } else {
+                buttons &= ~bit;
+                released |= bit;
+            }
+        }
+        
+        ButtonMask tracked = recognizer.tracked();
+        ButtonMask gesture_buttons = table.deferred | tracked;
+        if (((pressed | released) & gesture_buttons) == 0 && tracked == 0) continue;
+        recognizer.update(table, bindings, buttons, pressed & gesture_buttons, released & tracked, edge_ns, now_ns);
+        for (const auto& event : recognizer.events()) {
+            fired += describe(event.binding.action, event.down);
+        }
+    }
+    CHECK_EQ(recognizer.tracked(), ButtonMask{0});
+    return fired;
+}
+
+constexpr GamepadButton kLB = GamepadButton::LeftShoulder;
+constexpr GamepadButton kA = GamepadButton::A;
+constexpr GamepadButton kX = GamepadButton::X;
+constexpr GamepadButton kY = GamepadButton::Y;
+
+const std::vector<Script>& scripts() {
+    static const std::vector<Script> kScripts = {
+        {"chord inside chord_window_ms",
+         {{100, kLB, true}, {120, kA, true}, {300, kA, false}, {320, kLB, false}},
+         {{ButtonAction::AltTab, true}, {ButtonAction::AltTab, false}}},
+        {"chord pressed in one frame",
+         {{100, kLB, true}, {100, kA, true}, {300, kLB, false}, {300, kA, false}},
+         {{ButtonAction::AltTab, true}, {ButtonAction::AltTab, false}}},
+        {"lone chord member acts after chord_window_ms",
+         {{100, kA, true}, {200, kA, false}},
+         {{ButtonAction::LeftClick, true}, {ButtonAction::LeftClick, false}}},
+        {"lone chord member tapped inside chord_window_ms",
+         {{100, kA, true}, {130, kA, false}},
+         {{ButtonAction::LeftClick, true}, {ButtonAction::LeftClick, false}}},
+        {"second chord member too late",
+         {{100, kLB, true}, {200, kA, true}, {300, kA, false}, {320, kLB, false}},
+         {{ButtonAction::MiddleClick, true}, {ButtonAction::LeftClick, true},
+          {ButtonAction::LeftClick, false}, {ButtonAction::MiddleClick, false}}},
+        {"chord member released before the other",
+         {{100, kLB, true}, {120, kA, true}, {200, kLB, false}, {500, kA, false}},
+         {{ButtonAction::AltTab, true}, {ButtonAction::AltTab, false}}},
+        {"chord member pressed again while the other is still held",
+         {{100, kLB, true}, {120, kA, true}, {200, kLB, false}, {250, kLB, true}, {300, kA, false}, {400, kLB, false}},
+         {{ButtonAction::AltTab, true}, {ButtonAction::AltTab, false},
+          {ButtonAction::MiddleClick, true}, {ButtonAction::MiddleClick, false}}},
+        {"tap shorter than hold_ms",
+         {{100, kX, true}, {450, kX, false}},
+         {{ButtonAction::Escape, true}, {ButtonAction::Escape, false}}},
+        {"long press reaches hold_ms",
+         {{100, kX, true}, {800, kX, false}},
+         {{ButtonAction::MediaNext, true}, {ButtonAction::MediaNext, false}}},
+        {"double tap inside double_tap_ms",
+         {{100, kY, true}, {150, kY, false}, {350, kY, true}, {380, kY, false}},
+         {{ButtonAction::Screenshot, true}, {ButtonAction::Screenshot, false}}},
+        {"two taps outside double_tap_ms",
+         {{100, kY, true}, {150, kY, false}, {450, kY, true}, {480, kY, false}},
+         {{ButtonAction::Enter, true}, {ButtonAction::Enter, false},
+          {ButtonAction::Enter, true}, {ButtonAction::Enter, false}}},
+        {"double tap button held past hold_ms",
+         {{100, kY, true}, {700, kY, false}},
+         {{ButtonAction::Enter, true}, {ButtonAction::Enter, false}}},
+        {"gestures on two buttons interleaved",
+         {{100, kX, true}, {150, kY, true}, {200, kY, false}, {300, kY, true}, {350, kY, false}, {700, kX, false}},
+         {{ButtonAction::Screenshot, true}, {ButtonAction::Screenshot, false},
+          {ButtonAction::MediaNext, true}, {ButtonAction::MediaNext, false}}},
+    };
+    return kScripts;
+}
+
+void testScripts() {
+    const GestureTable table = gestureTable();
+    for (const auto& script : scripts()) {
+        std::string expected = describe(script.expected);
+        for (uint32_t frame_ms : {1u, 16u, 0u}) {
+            std::string fired = play(table, script, frame_ms);
+            if (fired != expected) {
+                std::cerr << script.name << " (frame_ms " << frame_ms << ")" << std::endl;
+            }
+            CHECK_EQ(fired, expected);
+        }
+    }
+}
+
+void testDeadlines() {
+    const GestureTable table = gestureTable();
+    const auto bindings = plainBindings();
+    GestureRecognizer recognizer;
+    CHECK_EQ(recognizer.nextDeadlineNs(table), GestureRecognizer::kNoDeadline);
+    
+    // A pressed chord member waits chord_window_ms, a long-press button hold_ms
+    ButtonMask buttons = buttonBit(kA) | buttonBit(kX);
+    recognizer.update(table, bindings, buttons, buttons, 0, 100 * kNsPerMs, 105 * kNsPerMs);
+    CHECK(recognizer.events().empty());
+    CHECK_EQ(recognizer.tracked(), buttons);
+    CHECK_EQ(recognizer.nextDeadlineNs(table), 150 * kNsPerMs);
+    
+    recognizer.update(table, bindings, buttons, 0, 0, 150 * kNsPerMs, 150 * kNsPerMs);
+    CHECK_EQ(recognizer.events().size(), size_t{1});
+    CHECK_EQ(recognizer.nextDeadlineNs(table), 500 * kNsPerMs);
+    
+    // A tap on the double-tap button waits double_tap_ms from its release
+    recognizer.update(table, bindings, buttons | buttonBit(kY), buttonBit(kY), 0, 200 * kNsPerMs, 200 * kNsPerMs);
+    recognizer.update(table, bindings, buttons, 0, buttonBit(kY), 220 * kNsPerMs, 220 * kNsPerMs);
+    CHECK_EQ(recognizer.nextDeadlineNs(table), 470 * kNsPerMs);
+}
+
+} // namespace
+
+int main() {
+    testScripts();
+    testDeadlines();
+    return testExitCode("gesture_recognizer_test");
+}
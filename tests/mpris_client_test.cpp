@@ -0,0 +1,228 @@
+// MprisClient against fake players on a private session bus: a dbus-daemon
+// started just for this test, and players that answer GetAll and emit
+// PropertiesChanged like a real one. Exits 77 (skipped) when dbus-daemon
+// cannot be started.
+#include <dbus/dbus.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "mpris_client.h"
+#include "test_util.h"
+
+namespace {
+
+constexpr int kSkipped = 77;
+constexpr const char* kFirstPlayer = "org.mpris.MediaPlayer2.first";
+constexpr const char* kSecondPlayer = "org.mpris.MediaPlayer2.second";
+
+// Poll condition until it holds or two seconds pass
+bool waitFor(const std::function<bool()>& condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return true;
+}
+
+class PrivateBus {
+public:
+    ~PrivateBus() {
+        if (pid_ > 0) kill(pid_, SIGTERM);
+    }
+    
+    // Start the daemon and point DBUS_SESSION_BUS_ADDRESS at it
+    bool start() {
+        FILE* output = popen("dbus-daemon --session --fork --print-address=1 --print-pid=1 2>/dev/null", "r");
+        if (!output) return false;
+        char address[512] = {};
+        char pid[32] = {};
+        bool read = std::fgets(address, sizeof(address), output) && std::fgets(pid, sizeof(pid), output);
+        pclose(output);
+        if (!read) return false;
+        
+        address[std::strcspn(address, "\n")] = '\0';
+        pid_ = static_cast<pid_t>(std::atoi(pid));
+        return pid_ > 0 && setenv("DBUS_SESSION_BUS_ADDRESS", address, 1) == 0;
+    }
+    
+private:
+    pid_t pid_ = 0;
+};
+
+void appendProperty(DBusMessageIter* dict, const char* key, int type, const void* value) {
+    const char signature[2] = {static_cast<char>(type), '\0'};
+    DBusMessageIter entry;
+    DBusMessageIter variant;
+    dbus_message_iter_open_container(dict, DBUS_TYPE_DICT_ENTRY, nullptr, &entry);
+    dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &key);
+    dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT, signature, &variant);
+    dbus_message_iter_append_basic(&variant, type, value);
+    dbus_message_iter_close_container(&entry, &variant);
+    dbus_message_iter_close_container(dict, &entry);
+}
+
+// One player on its own connection, answering on its own thread
+class FakePlayer {
+public:
+    ~FakePlayer() {
+        stop();
+    }
+    
+    bool start(const char* name, const char* status, double volume) {
+        status_ = status;
+        volume_ = volume;
+        connection_ = dbus_bus_get_private(DBUS_BUS_SESSION, nullptr);
+        if (!connection_) return false;
+        dbus_connection_set_exit_on_disconnect(connection_, FALSE);
+        dbus_connection_add_filter(connection_, &FakePlayer::handleMessage, this, nullptr);
+        if (dbus_bus_request_name(connection_, name, DBUS_NAME_FLAG_DO_NOT_QUEUE, nullptr) !=
+            DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER) {
+            return false;
+        }
+        running_ = true;
+        thread_ = std::thread([this]() {
+            while (running_ && dbus_connection_read_write_dispatch(connection_, 10)) {
+            }
+        });
+        return true;
+    }
+    
+    // Closing the connection makes the name vanish
+    void stop() {
+        if (!connection_) return;
+        running_ = false;
+        if (thread_.joinable()) thread_.join();
+        dbus_connection_close(connection_);
+        dbus_connection_unref(connection_);
+        connection_ = nullptr;
+    }
+    
+    void setStatus(const char* status) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            status_ = status;
+        }
+        DBusMessage* signal = dbus_message_new_signal("/org/mpris/MediaPlayer2", "org.freedesktop.DBus.Properties",
+                                                      "PropertiesChanged");
+        const char* interface = "org.mpris.MediaPlayer2.Player";
+        DBusMessageIter args;
+        DBusMessageIter changed;
+        DBusMessageIter invalidated;
+        dbus_message_iter_init_append(signal, &args);
+        dbus_message_iter_append_basic(&args, DBUS_TYPE_STRING, &interface);
+        dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "{sv}", &changed);
+        appendProperty(&changed, "PlaybackStatus", DBUS_TYPE_STRING, &status);
+        dbus_message_iter_close_container(&args, &changed);
+        dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "s", &invalidated);
+        dbus_message_iter_close_container(&args, &invalidated);
+        dbus_connection_send(connection_, signal, nullptr);
+        dbus_connection_flush(connection_);
+        dbus_message_unref(signal);
+    }
+    
+    std::string lastCommand() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return last_command_;
+    }
+    
+private:
+    DBusConnection* connection_ = nullptr;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::mutex mutex_;
+    std::string status_;
+    double volume_ = 0.0;
+    std::string last_command_;
+    
+    static DBusHandlerResult handleMessage(DBusConnection* connection, DBusMessage* message, void* user_data) {
+        auto* self = static_cast<FakePlayer*>(user_data);
+        if (dbus_message_is_method_call(message, "org.freedesktop.DBus.Properties", "GetAll")) {
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            const char* status = self->status_.c_str();
+            DBusMessage* reply = dbus_message_new_method_return(message);
+            DBusMessageIter args;
+            DBusMessageIter properties;
+            dbus_message_iter_init_append(reply, &args);
+            dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "{sv}", &properties);
+            appendProperty(&properties, "PlaybackStatus", DBUS_TYPE_STRING, &status);
+            appendProperty(&properties, "Volume", DBUS_TYPE_DOUBLE, &self->volume_);
+            dbus_message_iter_close_container(&args, &properties);
+            dbus_connection_send(connection, reply, nullptr);
+            dbus_message_unref(reply);
+            return DBUS_HANDLER_RESULT_HANDLED;
+        }
+        if (dbus_message_has_interface(message, "org.mpris.MediaPlayer2.Player")) {
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            self->last_command_ = dbus_message_get_member(message);
+            return DBUS_HANDLER_RESULT_HANDLED;
+        }
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+};
+
+void testPlayers() {
+    // A player already on the bus is found at connect with its properties
+    FakePlayer first;
+    CHECK(first.start(kFirstPlayer, "Paused", 0.5));
+    MprisClient client;
+    CHECK(client.connect());
+    CHECK(waitFor([&] { return client.hasPlayer(); }));
+    CHECK_EQ(client.getCurrentPlayer(), std::string(kFirstPlayer));
+    CHECK(!client.isPlaying());
+    CHECK_EQ(client.getVolume(), 50);
+    
+    // PlaybackStatus changes follow PropertiesChanged
+    first.setStatus("Playing");
+    CHECK(waitFor([&] { return client.isPlaying(); }));
+    first.setStatus("Paused");
+    CHECK(waitFor([&] { return !client.isPlaying(); }));
+    
+    // Commands go to the current player
+    CHECK(client.sendPlayerCommand("PlayPause"));
+    CHECK(waitFor([&] { return first.lastCommand() == "PlayPause"; }));
+    
+    // A player appearing later is picked up; a playing one wins
+    FakePlayer second;
+    CHECK(second.start(kSecondPlayer, "Playing", 0.8));
+    CHECK(waitFor([&] { return client.getCurrentPlayer() == kSecondPlayer; }));
+    CHECK(client.isPlaying());
+    CHECK_EQ(client.getVolume(), 80);
+    
+    // It still follows both: the first one playing again takes over
+    second.setStatus("Paused");
+    CHECK(waitFor([&] { return !client.isPlaying(); }));
+    first.setStatus("Playing");
+    CHECK(waitFor([&] { return client.getCurrentPlayer() == kFirstPlayer && client.isPlaying(); }));
+    
+    // Players vanishing fall back to the remaining one, then to none
+    first.stop();
+    CHECK(waitFor([&] { return client.getCurrentPlayer() == kSecondPlayer; }));
+    CHECK(!client.isPlaying());
+    second.stop();
+    CHECK(waitFor([&] { return !client.hasPlayer(); }));
+    CHECK_EQ(client.getVolume(), -1);
+    CHECK(!client.sendPlayerCommand("PlayPause"));
+    
+    client.disconnect();
+}
+
+} // namespace
+
+int main() {
+    PrivateBus bus;
+    if (!bus.start()) {
+        std::cout << "mpris_client_test: dbus-daemon unavailable, skipped" << std::endl;
+        return kSkipped;
+    }
+    testPlayers();
+    return testExitCode("mpris_client_test");
+}
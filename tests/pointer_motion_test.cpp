@@ -0,0 +1,171 @@
+// PointerMotion only depends on the deflection and the dt it is given, so
+// the same stick held for the same time must move the pointer the same
+// distance at any loop rate, and acceleration must follow ramp_ms exactly.
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include "pointer_motion.h"
+#include "test_util.h"
+
+namespace {
+
+constexpr int kLoopRates[] = {60, 250, 1000};
+
+struct Travel {
+    int x = 0;
+    int y = 0;
+};
+
+// Hold (x, y) with the precision trigger at precision for seconds, in
+// frames of 1/rate_hz
+Travel hold(PointerMotion& motion, float x, float y, float precision, double seconds, int rate_hz) {
+    Travel travel;
+    int frames = static_cast<int>(std::lround(seconds * rate_hz));
+    for (int frame = 0; frame < frames; ++frame) {
+        int delta_x = 0;
+        int delta_y = 0;
+        motion.integrate(x, y, precision, 1.0 / rate_hz, delta_x, delta_y);
+        travel.x += delta_x;
+        travel.y += delta_y;
+    }
+    return travel;
+}
+
+PointerAcceleration noAcceleration() {
+    PointerAcceleration acceleration;
+    acceleration.max_gain = 1.0f;
+    return acceleration;
+}
+
+void testLoopRateIndependence() {
+    // 0.5 deflection at 900 px/s for 2 s is 900 px whatever the rate; the
+    // carried fraction may leave at most one pixel behind
+    for (int rate : kLoopRates) {
+        PointerMotion motion;
+        motion.setAcceleration(noAcceleration());
+        Travel travel = hold(motion, 0.5f, -0.25f, 0.0f, 2.0, rate);
+        CHECK(std::abs(travel.x - 900) <= 1);
+        CHECK(std::abs(travel.y + 450) <= 1);
+    }
+    
+    // Deflections too small to move a pixel per frame still add up
+    for (int rate : kLoopRates) {
+        PointerMotion motion;
+        motion.setAcceleration(noAcceleration());
+        Travel travel = hold(motion, 0.01f, 0.0f, 0.0f, 2.0, rate);
+        CHECK(std::abs(travel.x - 18) <= 1);
+    }
+    
+    // With acceleration (default max_gain 2 over 500 ms) the ramp is sampled
+    // once per frame, so a slower loop may be ahead by the extra gain of one
+    // frame at most: 1500 px at 1 kHz
+    for (int rate : kLoopRates) {
+        PointerMotion motion;
+        Travel travel = hold(motion, 1.0f, 0.0f, 0.0f, 1.0, rate);
+        CHECK(std::abs(travel.x - 1500) <= 900 / rate + 1);
+    }
+}
+
+void testRampReachesMaxGain() {
+    PointerAcceleration acceleration;
+    acceleration.max_gain = 3.0f;
+    acceleration.ramp_ms = 400;
+    acceleration.threshold = 0.9f;
+    
+    for (int rate : kLoopRates) {
+        PointerMotion motion;
+        motion.setAcceleration(acceleration);
+        CHECK_EQ(motion.getAccelerationGain(), 1.0f);
+        
+        // Below the threshold nothing builds up
+        hold(motion, 0.8f, 0.0f, 0.0f, 1.0, rate);
+        CHECK_EQ(motion.getAccelerationGain(), 1.0f);
+        
+        // Full deflection: still short of max_gain one frame before ramp_ms,
+        // there at ramp_ms and it stays there
+        hold(motion, 1.0f, 0.0f, 0.0f, 0.4 - 1.0 / rate, rate);
+        CHECK(motion.getAccelerationGain() > 1.0f);
+        CHECK(motion.getAccelerationGain() < 3.0f);
+        hold(motion, 1.0f, 0.0f, 0.0f, 1.0 / rate, rate);
+        CHECK(std::fabs(motion.getAccelerationGain() - 3.0f) < 1e-4f);
+        hold(motion, 1.0f, 0.0f, 0.0f, 0.5, rate);
+        CHECK_EQ(motion.getAccelerationGain(), 3.0f);
+        
+        // Easing off drops the ramp four times as fast
+        hold(motion, 0.0f, 0.0f, 0.0f, 0.1, rate);
+        CHECK_EQ(motion.getAccelerationGain(), 1.0f);
+    }
+    
+    // Halfway past the threshold builds the ramp at half the speed
+    PointerMotion half;
+    half.setAcceleration(acceleration);
+    hold(half, 0.95f, 0.0f, 0.0f, 0.4, 1000);
+    CHECK(half.getAccelerationGain() < 3.0f);
+    hold(half, 0.95f, 0.0f, 0.0f, 0.4, 1000);
+    CHECK(std::fabs(half.getAccelerationGain() - 3.0f) < 1e-4f);
+    
+    // max_gain 1 never accelerates
+    PointerMotion off;
+    off.setAcceleration(noAcceleration());
+    hold(off, 1.0f, 0.0f, 0.0f, 1.0, 1000);
+    CHECK_EQ(off.getAccelerationGain(), 1.0f);
+}
+
+void testPrecisionTrigger() {
+    PointerAcceleration acceleration = noAcceleration();
+    acceleration.precision_gain = 0.25f;
+    
+    // The speed scales linearly from 1 (released) to precision_gain (fully
+    // pulled): 900, 562.5 and 225 px over a second at full deflection
+    const float pulls[] = {0.0f, 0.5f, 1.0f};
+    const int expected[] = {900, 562, 225};
+    for (size_t index = 0; index < 3; ++index) {
+        for (int rate : kLoopRates) {
+            PointerMotion motion;
+            motion.setAcceleration(acceleration);
+            Travel travel = hold(motion, 1.0f, 0.0f, pulls[index], 1.0, rate);
+            CHECK(std::abs(travel.x - expected[index]) <= 1);
+        }
+    }
+    
+    // It scales the accelerated speed too, and leaves the ramp alone
+    PointerAcceleration accelerated;
+    accelerated.max_gain = 2.0f;
+    accelerated.precision_gain = 0.5f;
+    PointerMotion motion;
+    motion.setAcceleration(accelerated);
+    hold(motion, 1.0f, 0.0f, 1.0f, 1.0, 1000);
+    CHECK_EQ(motion.getAccelerationGain(), 2.0f);
+    Travel travel = hold(motion, 1.0f, 0.0f, 1.0f, 1.0, 1000);
+    CHECK(std::abs(travel.x - 900) <= 1);
+}
+
+void testReplayIsIdentical() {
+    // Same deflections and dt twice: every frame's delta matches
+    PointerMotion first;
+    PointerMotion second;
+    bool identical = true;
+    for (int frame = 0; frame < 5000; ++frame) {
+        float x = static_cast<float>(std::sin(frame * 0.003));
+        float y = static_cast<float>(std::cos(frame * 0.005));
+        double dt = (frame % 7 + 1) / 1000.0;
+        int first_x = 0;
+        int first_y = 0;
+        int second_x = 0;
+        int second_y = 0;
+        first.integrate(x, y, 0.0f, dt, first_x, first_y);
+        second.integrate(x, y, 0.0f, dt, second_x, second_y);
+        identical = identical && first_x == second_x && first_y == second_y;
+    }
+    CHECK(identical);
+}
+
+} // namespace
+
+int main() {
+    testLoopRateIndependence();
+    testRampReachesMaxGain();
+    testPrecisionTrigger();
+    testReplayIsIdentical();
+    return testExitCode("pointer_motion_test");
+}
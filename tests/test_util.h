@@ -0,0 +1,45 @@
+#pragma once
+#include <iostream>
+
+// Minimal checks for the ctest executables: a failed CHECK prints the
+// expression and keeps going, testExitCode() turns any failure into a
+// non-zero exit status for ctest.
+inline int& failureCount() {
+    static int count = 0;
+    return count;
+}
+
+inline void reportFailure(const char* file, int line, const char* expression) {
+    std::cerr << file << ":" << line << ": CHECK(" << expression << ") failed" << std::endl;
+    ++failureCount();
+}
+
+template <typename A, typename B>
+void reportMismatch(const char* file, int line, const char* expression, const A& actual, const B& expected) {
+    std::cerr << file << ":" << line << ": CHECK_EQ(" << expression << ") failed: " << actual
+              << " != " << expected << std::endl;
+    ++failureCount();
+}
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) reportFailure(__FILE__, __LINE__, #expr); \
+    } while (0)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        auto&& check_actual_ = (actual); \
+        auto&& check_expected_ = (expected); \
+        if (!(check_actual_ == check_expected_)) { \
+            reportMismatch(__FILE__, __LINE__, #actual ", " #expected, check_actual_, check_expected_); \
+        } \
+    } while (0)
+
+inline int testExitCode(const char* name) {
+    if (failureCount() == 0) {
+        std::cout << name << ": all checks passed" << std::endl;
+        return 0;
+    }
+    std::cerr << name << ": " << failureCount() << " check(s) failed" << std::endl;
+    return 1;
+}
@@ -0,0 +1,155 @@
+// TimerWheel with synthetic timestamps: slot order, timers a lap or more
+// ahead, stalls longer than the wheel, overdue schedules and re-arming from
+// inside fire.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "test_util.h"
+#include "timer_wheel.h"
+
+namespace {
+
+constexpr uint64_t kNsPerMs = 1000000;
+
+struct Firing {
+    size_t id;
+    uint64_t at_ms;
+    
+    bool operator==(const Firing& other) const = default;
+};
+
+// Advance in step_ms frames up to to_ms and list what fired when
+std::vector<Firing> run(TimerWheel& wheel, uint64_t from_ms, uint64_t to_ms, uint64_t step_ms) {
+    std::vector<Firing> fired;
+    for (uint64_t now_ms = from_ms; now_ms <= to_ms; now_ms += step_ms) {
+        wheel.advance(now_ms * kNsPerMs, [&](size_t id) { fired.push_back({id, now_ms}); });
+    }
+    return fired;
+}
+
+void testSlotOrder() {
+    TimerWheel wheel;
+    CHECK_EQ(wheel.nextDeadlineNs(), TimerWheel::kNoDeadline);
+    wheel.schedule(3, 30 * kNsPerMs);
+    wheel.schedule(1, 10 * kNsPerMs);
+    wheel.schedule(2, 20 * kNsPerMs + 500000);
+    CHECK_EQ(wheel.nextDeadlineNs(), 10 * kNsPerMs);
+    CHECK(wheel.isPending(2));
+    
+    // A due time inside a slot waits for it, not just for the slot
+    std::vector<Firing> fired = run(wheel, 0, 40, 1);
+    std::vector<Firing> expected = {{1, 10}, {2, 21}, {3, 30}};
+    CHECK(fired == expected);
+    CHECK(!wheel.isPending(2));
+    CHECK_EQ(wheel.nextDeadlineNs(), TimerWheel::kNoDeadline);
+    
+    // Several timers in one frame fire in slot order
+    wheel.schedule(5, 52 * kNsPerMs);
+    wheel.schedule(4, 51 * kNsPerMs);
+    fired = run(wheel, 60, 60, 1);
+    expected = {{4, 60}, {5, 60}};
+    CHECK(fired == expected);
+}
+
+void testLaterLaps() {
+    TimerWheel wheel;
+    wheel.advance(0, [](size_t) {});
+    
+    // 1500 ms is beyond one lap: slot 476 comes round at 476 ms first
+    wheel.schedule(7, 1500 * kNsPerMs);
+    wheel.schedule(8, 3 * TimerWheel::kSlotCount * kNsPerMs);
+    std::vector<Firing> fired = run(wheel, 1, 3200, 1);
+    std::vector<Firing> expected = {{7, 1500}, {8, 3 * TimerWheel::kSlotCount}};
+    CHECK(fired == expected);
+}
+
+void testStallLongerThanWheel() {
+    TimerWheel wheel;
+    wheel.advance(0, [](size_t) {});
+    wheel.schedule(0, 10 * kNsPerMs);
+    wheel.schedule(1, 500 * kNsPerMs);
+    wheel.schedule(2, 1023 * kNsPerMs);
+    wheel.schedule(3, 4000 * kNsPerMs);
+    wheel.schedule(4, 6000 * kNsPerMs);
+    
+    // One call 5 s later walks one lap and fires each due timer once
+    std::vector<Firing> fired = run(wheel, 5000, 5000, 1);
+    CHECK_EQ(fired.size(), size_t{4});
+    CHECK(wheel.isPending(4));
+    CHECK_EQ(wheel.nextDeadlineNs(), 6000 * kNsPerMs);
+    
+    fired = run(wheel, 5001, 6000, 1);
+    std::vector<Firing> expected = {{4, 6000}};
+    CHECK(fired == expected);
+}
+
+void testOverdueAndCancel() {
+    TimerWheel wheel;
+    run(wheel, 0, 100, 1);
+    
+    // Already due: fires on the next call even within the same slot
+    wheel.schedule(9, 40 * kNsPerMs);
+    std::vector<Firing> fired = run(wheel, 100, 100, 1);
+    std::vector<Firing> expected = {{9, 100}};
+    CHECK(fired == expected);
+    
+    // Re-arming moves a timer, cancelling drops it
+    wheel.schedule(10, 150 * kNsPerMs);
+    wheel.schedule(10, 120 * kNsPerMs);
+    wheel.schedule(11, 130 * kNsPerMs);
+    wheel.cancel(11);
+    wheel.cancel(11);
+    CHECK(!wheel.isPending(11));
+    CHECK_EQ(wheel.nextDeadlineNs(), 120 * kNsPerMs);
+    fired = run(wheel, 101, 200, 1);
+    expected = {{10, 120}};
+    CHECK(fired == expected);
+    
+    // Ids past the capacity are ignored
+    wheel.schedule(TimerWheel::kCapacity, 210 * kNsPerMs);
+    CHECK(!wheel.isPending(TimerWheel::kCapacity));
+    CHECK_EQ(wheel.nextDeadlineNs(), TimerWheel::kNoDeadline);
+}
+
+void testRearmFromFire() {
+    // A periodic timer re-armed every 25 ms from its own fire, advanced in
+    // uneven frames: each firing at the first frame at or after its due time
+    TimerWheel wheel;
+    uint64_t due_ms = 25;
+    wheel.schedule(0, due_ms * kNsPerMs);
+    std::vector<uint64_t> fired_at;
+    for (uint64_t now_ms = 0; now_ms <= 200; now_ms += 7) {
+        wheel.advance(now_ms * kNsPerMs, [&](size_t id) {
+            fired_at.push_back(now_ms);
+            due_ms += 25;
+            wheel.schedule(id, due_ms * kNsPerMs);
+        });
+    }
+    std::vector<uint64_t> expected = {28, 56, 77, 105, 126, 154, 175};
+    CHECK(fired_at == expected);
+    CHECK_EQ(wheel.nextDeadlineNs(), 200 * kNsPerMs);
+    
+    // Re-armed already due (to a slot this call has walked past) from inside
+    // fire: it still fires again by the next call instead of a lap later
+    TimerWheel overdue;
+    overdue.advance(0, [](size_t) {});
+    overdue.schedule(1, 9 * kNsPerMs);
+    int count = 0;
+    overdue.advance(10 * kNsPerMs, [&](size_t id) {
+        if (++count == 1) overdue.schedule(id, 5 * kNsPerMs);
+    });
+    overdue.advance(11 * kNsPerMs, [&](size_t) { ++count; });
+    CHECK_EQ(count, 2);
+    CHECK(!overdue.isPending(1));
+}
+
+} // namespace
+
+int main() {
+    testSlotOrder();
+    testLaterLaps();
+    testStallLongerThanWheel();
+    testOverdueAndCancel();
+    testRearmFromFire();
+    return testExitCode("timer_wheel_test");
+}
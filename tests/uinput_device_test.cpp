@@ -0,0 +1,170 @@
+// UinputDevice writes a whole frame of input_events per submit(). Adopting
+// one end of a pipe instead of /dev/uinput lets the test read the stream
+// back exactly as the kernel would receive it.
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+#include <unistd.h>
+#include <X11/keysym.h>
+#include "test_util.h"
+#include "uinput_device.h"
+
+namespace {
+
+struct Expected {
+    unsigned short type;
+    unsigned short code;
+    int value;
+};
+
+class PipeDevice {
+public:
+    PipeDevice() {
+        int fds[2];
+        CHECK(pipe(fds) == 0);
+        read_fd_ = fds[0];
+        write_fd_ = fds[1];
+        device_.adopt(write_fd_);
+    }
+    
+    ~PipeDevice() {
+        device_.close();
+        ::close(read_fd_);
+        ::close(write_fd_);
+    }
+    
+    bool submit(std::initializer_list<OutputCommand> commands) {
+        OutputBuffer buffer;
+        for (const auto& command : commands) {
+            buffer.push(command);
+        }
+        return device_.submit(buffer);
+    }
+    
+    // Everything written since the last call; one submit() is one write()
+    std::vector<input_event> readBack() {
+        std::vector<input_event> events(256);
+        ssize_t size = read(read_fd_, events.data(), events.size() * sizeof(input_event));
+        CHECK(size >= 0 && size % static_cast<ssize_t>(sizeof(input_event)) == 0);
+        events.resize(size > 0 ? static_cast<size_t>(size) / sizeof(input_event) : 0);
+        return events;
+    }
+    
+    UinputDevice& device() { return device_; }
+
+private:
+    UinputDevice device_;
+    int read_fd_ = -1;
+    int write_fd_ = -1;
+};
+
+OutputCommand move(int x, int y) {
+    return {OutputCommandType::MouseMove, MouseButton::Left, false, x, y};
+}
+
+OutputCommand click(MouseButton button, bool down) {
+    return {OutputCommandType::MouseButton, button, down, 0, 0};
+}
+
+OutputCommand scroll(int x, int y) {
+    return {OutputCommandType::Scroll, MouseButton::Left, false, x, y};
+}
+
+OutputCommand key(unsigned long keysym, bool down) {
+    return {OutputCommandType::Key, MouseButton::Left, down, static_cast<int32_t>(keysym), 0};
+}
+
+void checkEvents(const std::vector<input_event>& events, std::initializer_list<Expected> expected) {
+    CHECK_EQ(events.size(), expected.size());
+    size_t index = 0;
+    for (const auto& want : expected) {
+        if (index >= events.size()) break;
+        CHECK_EQ(events[index].type, want.type);
+        CHECK_EQ(events[index].code, want.code);
+        CHECK_EQ(events[index].value, want.value);
+        ++index;
+    }
+}
+
+void testMotionAndButtons() {
+    PipeDevice pipe;
+    CHECK(pipe.device().isOpen());
+    
+    CHECK(pipe.submit({move(5, -3), click(MouseButton::Right, true)}));
+    checkEvents(pipe.readBack(), {
+        {EV_REL, REL_X, 5},
+        {EV_REL, REL_Y, -3},
+        {EV_KEY, BTN_RIGHT, 1},
+        {EV_SYN, SYN_REPORT, 0},
+    });
+    
+    // A zero axis is left out rather than sent as 0
+    CHECK(pipe.submit({move(0, 7), click(MouseButton::Right, false)}));
+    checkEvents(pipe.readBack(), {
+        {EV_REL, REL_Y, 7},
+        {EV_KEY, BTN_RIGHT, 0},
+        {EV_SYN, SYN_REPORT, 0},
+    });
+}
+
+void testTapInOneFrame() {
+    PipeDevice pipe;
+    
+    // The release must land in a later SYN frame than the press
+    CHECK(pipe.submit({key(XK_Control_L, true), key(XK_c, true), key(XK_c, false), key(XK_Control_L, false)}));
+    checkEvents(pipe.readBack(), {
+        {EV_KEY, KEY_LEFTCTRL, 1},
+        {EV_KEY, KEY_C, 1},
+        {EV_SYN, SYN_REPORT, 0},
+        {EV_KEY, KEY_C, 0},
+        {EV_KEY, KEY_LEFTCTRL, 0},
+        {EV_SYN, SYN_REPORT, 0},
+    });
+    
+    // Upper case maps to the same key; unknown keysyms write nothing
+    CHECK(pipe.submit({key(XK_C, true)}));
+    checkEvents(pipe.readBack(), {{EV_KEY, KEY_C, 1}, {EV_SYN, SYN_REPORT, 0}});
+    CHECK(pipe.submit({key(XK_ydiaeresis, true)}));
+    CHECK(pipe.submit({move(1, 0)}));
+    checkEvents(pipe.readBack(), {{EV_REL, REL_X, 1}, {EV_SYN, SYN_REPORT, 0}});
+}
+
+void testWheelNotches() {
+    PipeDevice pipe;
+    
+    // Half a notch: only the hi-res axis moves
+    CHECK(pipe.submit({scroll(0, kWheelUnitsPerNotch / 2)}));
+#ifdef REL_WHEEL_HI_RES
+    checkEvents(pipe.readBack(), {{EV_REL, REL_WHEEL_HI_RES, 60}, {EV_SYN, SYN_REPORT, 0}});
+#endif
+
+    // The second half completes a legacy notch
+    CHECK(pipe.submit({scroll(0, kWheelUnitsPerNotch / 2)}));
+#ifdef REL_WHEEL_HI_RES
+    checkEvents(pipe.readBack(), {
+        {EV_REL, REL_WHEEL_HI_RES, 60},
+        {EV_REL, REL_WHEEL, 1},
+        {EV_SYN, SYN_REPORT, 0},
+    });
+#else
+    checkEvents(pipe.readBack(), {{EV_REL, REL_WHEEL, 1}, {EV_SYN, SYN_REPORT, 0}});
+#endif
+}
+
+void testClosedDevice() {
+    UinputDevice device;
+    OutputBuffer buffer;
+    buffer.push(move(1, 1));
+    CHECK(!device.isOpen());
+    CHECK(!device.submit(buffer));
+}
+
+} // namespace
+
+int main() {
+    testMotionAndButtons();
+    testTapInOneFrame();
+    testWheelNotches();
+    testClosedDevice();
+    return testExitCode("uinput_device_test");
+}